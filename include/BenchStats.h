@@ -0,0 +1,69 @@
+//=============================================================================
+//
+//   BenchStats - Per-frame and summary results of a benchmark run
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef BENCHSTATS_H
+#define BENCHSTATS_H
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @brief Measurements of one frame after warmup
+ */
+struct FrameRecord {
+  float ms = 0.0f;            // CPU frame time
+  int visibleCount = 0;
+  int cacheMiss = 0;
+  uint64_t bytesStreamed = 0; // bytes uploaded into slots and subslots
+  int occluded = 0;           // blocks in the frustum hidden by occlusion culling
+};
+
+/**
+ * @brief Results of one run, filled by Rasterizer::render()
+ */
+struct BenchStats {
+  std::vector<FrameRecord> frames;
+  double avgFPS = 0.0;
+  double maxFPS = 0.0;
+  double minFPS = 0.0;
+  float p50_ms = 0.0f;
+  float p95_ms = 0.0f;
+  float p99_ms = 0.0f;
+  int maxVisibleCount = 0;
+  int minVisibleCount = 0;
+  int maxCacheMiss = 0;
+  int minCacheMiss = 0;
+  int maxInFlight = 0;
+  int cancelledJobs = 0;
+  uint64_t bytesStreamed = 0;
+  int prefetchLoads = 0;      // predicted blocks loaded into subslots
+  int prefetchHits = 0;       // of those, later taken from the cache
+  uint64_t cacheHits = 0;     // subslots cache counters
+  uint64_t cacheMisses = 0;
+  uint64_t cacheInserts = 0;
+  uint64_t cacheEvictions = 0;
+  int maxOccluded = 0;
+  int numBlocks = 0;
+  int numSlots = 0;
+  int numSubSlots = 0;
+
+  /** @brief Nearest-rank percentile of the frame times */
+  float framePercentile(float p) const {
+    if (frames.empty()) return 0.0f;
+    std::vector<float> ms(frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) ms[i] = frames[i].ms;
+    size_t k = (size_t)std::ceil(p * (float)ms.size());
+    k = std::min(std::max<size_t>(k, 1), ms.size()) - 1;
+    std::nth_element(ms.begin(), ms.begin() + k, ms.end());
+    return ms[k];
+  }
+};
+
+#endif // BENCHSTATS_H
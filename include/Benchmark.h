@@ -0,0 +1,80 @@
+//=============================================================================
+//
+//   Benchmark - Runs a matrix of rasterizer configurations
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <fstream>
+#include <filesystem>
+#include "RasterizerConfig.h"
+#include "BenchStats.h"
+
+/**
+ * @brief Lists of values to sweep, every combination is one run
+ *
+ * An empty list keeps the value of the base configuration. Lists are set
+ * from the command line ("--workers 2,5") or from a file with one
+ * "key = v1, v2" line per dimension, '#' starts a comment.
+ */
+struct BenchmarkMatrix {
+  std::vector<float> slotFactor;
+  std::vector<float> subslotRatio;
+  std::vector<int> workers;
+  std::vector<int> grid;
+  std::vector<uint64_t> maxBlockPoints;
+  std::vector<float> rotateAngle; // orbit of the test camera, degrees per second
+  std::vector<std::pair<unsigned int, unsigned int>> resolution;
+  std::vector<std::string> cameraPath; // recorded paths, "orbit" for the test orbit
+  std::vector<CachePolicy> cachePolicy;
+  std::vector<RenderBackend> backend;
+
+  /** @brief True if key names a dimension */
+  static bool isKey(const std::string& key);
+
+  /** @brief Set a dimension from a comma separated list */
+  bool set(const std::string& key, const std::string& values);
+
+  /** @brief Set dimensions from a file */
+  bool load(const std::filesystem::path& path);
+
+  /** @brief Number of combinations */
+  size_t size() const;
+
+  /** @brief Configuration of combination i */
+  RasterizerConfig at(const RasterizerConfig& base, size_t i) const;
+};
+
+/**
+ * @brief Runs every combination of a matrix and writes the results
+ *
+ * Results go to <prefix>_runs.csv (one row per run), <prefix>_frames.csv
+ * (one row per measured frame) and <prefix>.jsonl (one object per run).
+ * A full matrix run truncates them; a single run (runIndex >= 0) appends, so
+ * batched runs in separate processes end up in the same files.
+ */
+class Benchmark {
+public:
+  /** @brief Run the matrix, or only combination runIndex if >= 0 */
+  bool run(const RasterizerConfig& base, const BenchmarkMatrix& matrix, const std::string& prefix, int runIndex = -1);
+
+private:
+  /** @brief Open the output files, write headers into new or truncated ones */
+  bool open(const std::string& prefix, bool append);
+
+  /** @brief Append the results of one run */
+  void write(size_t run, const RasterizerConfig& config, bool ok, const BenchStats& stats);
+
+  std::ofstream runsCSV;
+  std::ofstream framesCSV;
+  std::ofstream json;
+};
+
+#endif // BENCHMARK_H
@@ -10,12 +10,10 @@
 #define BLOCK_H
 
 #include "Point.h"
+#include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-constexpr int GRID = 10;
-constexpr int NUM_BLOCKS = GRID*GRID*GRID;
-
 /**
  * @brief Spatial block for point cloud partitioning
  */
@@ -27,10 +25,10 @@ struct Block {
   float distanceToPlaneMin = 0.0f;
   float distanceToCameraCenter = 0.0f;
   float distanceToFrustumCenter = 0.0f;
+  int lodCount = 0; // LOD point budget of this frame, a prefix of the progressive order
 
-  // used only in in-core mode
+  // used only in in-core mode, the points live in the VBO only (quantized against bb_min/bb_max)
   unsigned int vbo = 0, vao = 0;
-  std::vector<Point> points;
 };
 
 
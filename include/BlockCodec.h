@@ -0,0 +1,68 @@
+//=============================================================================
+//
+//   BlockCodec - Chunked compression of the points in the block store
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef BLOCKCODEC_H
+#define BLOCKCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Point.h"
+
+constexpr size_t CHUNK_POINTS = 16384; // points per compressed chunk, the unit of partial reads
+constexpr int ZSTD_LEVEL = 1;          // fast end of zstd, decoding speed barely depends on it
+
+typedef enum {
+  COMPRESSION_NONE, // PointQ arrays, mapped and uploaded as they are
+  COMPRESSION_ZSTD  // chunks of CHUNK_POINTS, byte planes, zstd
+} Compression;
+
+/** @brief Name of a compression, as on the command line */
+const char* compressionName(Compression compression);
+
+/** @brief Parse none|zstd */
+bool parseCompression(const std::string& name, Compression& compression);
+
+/** @brief true if this build can read and write the compression */
+bool compressionAvailable(Compression compression);
+
+/**
+ * @brief Compress n <= CHUNK_POINTS points and append them to out
+ *
+ * The 12 bytes of a PointQ are split into byte planes first (all low bytes
+ * of x, all high bytes of x, ...). The high bytes, the padding and alpha are
+ * nearly constant, so the planes compress far better than the interleaved
+ * points.
+ *
+ * @param planes scratch space, reused between calls
+ * @return false if the compressor failed
+ */
+bool encodeChunk(Compression compression, const PointQ* points, size_t n,
+                 std::vector<unsigned char>& planes, std::vector<unsigned char>& out);
+
+/**
+ * @brief Decode the points [first, first + count) of a compressed block
+ *
+ * Only the chunks covering the range are decompressed, so prefix loads of
+ * LOD and refinement jobs read a fraction of the block.
+ *
+ * @param data stored bytes of the block from the first chunk of the range on,
+ *             i.e. the block start + chunks[first / CHUNK_POINTS]
+ * @param chunks byte offsets of the chunks in the block, one past the last at the end
+ * @param blockCount points in the whole block
+ * @param scratch decompressed chunk, reused between calls
+ * @return false if a chunk is corrupt
+ */
+bool decodeRange(Compression compression, const unsigned char* data, const uint32_t* chunks, size_t blockCount,
+                 size_t first, size_t count, PointQ* dst, std::vector<unsigned char>& scratch);
+
+/** @brief Number of chunks of a block with count points */
+inline size_t chunkCount(size_t count) { return (count + CHUNK_POINTS - 1) / CHUNK_POINTS; }
+
+#endif // BLOCKCODEC_H
@@ -0,0 +1,105 @@
+//=============================================================================
+//
+//   BlockReader - Batched reads of the packed block file (pread, io_uring)
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef BLOCKREADER_H
+#define BLOCKREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+constexpr int DEFAULT_IO_DEPTH = 8; // jobs a worker reads in one batch
+constexpr uint64_t IO_ALIGN = 4096; // O_DIRECT alignment of offsets, sizes and buffers
+
+typedef enum {
+  IO_MMAP,  // BlockStore mapping, pages faulted in by the workers
+  IO_PREAD, // one pread() per job of a batch
+  IO_URING  // one io_uring submission per batch, needs liburing
+} IOBackend;
+
+/** @brief Name of an I/O backend, as on the command line */
+const char* ioBackendName(IOBackend backend);
+
+/** @brief Parse mmap|pread|uring */
+bool parseIOBackend(const std::string& name, IOBackend& backend);
+
+/** @brief true if this build has the backend */
+bool ioBackendAvailable(IOBackend backend);
+
+/**
+ * @brief How the workers read the block store
+ */
+struct IOConfig {
+  IOBackend backend = IO_MMAP;
+  bool direct = false;        // O_DIRECT, not with IO_MMAP
+  int depth = DEFAULT_IO_DEPTH;
+};
+
+/**
+ * @brief One read of a batch
+ *
+ * With O_DIRECT offset, bytes and dst have to be multiples of IO_ALIGN.
+ */
+struct ReadRequest {
+  uint64_t offset = 0;
+  size_t bytes = 0;
+  void* dst = nullptr;
+  bool ok = false; // set by read(): all bytes arrived (or the file ended after them) without error
+  size_t need = 0; // bytes that have to arrive; the tail beyond is alignment padding
+};
+
+/**
+ * @brief Reads batches of byte ranges of one file, owned by one worker
+ */
+class BlockReader {
+public:
+  virtual ~BlockReader() = default;
+
+  /**
+   * @brief Open the file
+   * @param direct bypass the page cache (O_DIRECT), falls back to buffered reads if refused
+   * @param depth most requests per read() call
+   */
+  virtual bool open(const std::filesystem::path& path, bool direct, int depth) = 0;
+
+  /** @brief Read all requests, returns once every one has finished */
+  virtual void read(std::vector<ReadRequest>& requests) = 0;
+
+  /** @brief true if the file is open with O_DIRECT */
+  bool isDirect() const { return direct; }
+
+  /** @brief Reader of a backend, nullptr for IO_MMAP or a backend missing in this build */
+  static std::unique_ptr<BlockReader> create(IOBackend backend);
+
+protected:
+  /** @brief open() with O_DIRECT if asked and possible, -1 on error */
+  int openFile(const std::filesystem::path& path, bool wantDirect);
+
+  /** @brief pread() until need bytes or the end of the file */
+  bool readFully(int fd, ReadRequest& req, size_t done) const;
+
+  bool direct = false;
+};
+
+/**
+ * @brief Synchronous pread() per request
+ */
+class PreadReader : public BlockReader {
+public:
+  ~PreadReader() override;
+  bool open(const std::filesystem::path& path, bool direct, int depth) override;
+  void read(std::vector<ReadRequest>& requests) override;
+
+private:
+  int fd = -1;
+};
+
+#endif // BLOCKREADER_H
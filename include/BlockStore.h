@@ -0,0 +1,60 @@
+//=============================================================================
+//
+//   BlockStore - Memory-mapped packed block file
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef BLOCKSTORE_H
+#define BLOCKSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// block data in the packed file starts at multiples of this, so madvise()
+// ranges never straddle two blocks
+constexpr uint64_t BLOCK_ALIGN = 4096;
+
+/**
+ * @brief Read-only memory mapping of the packed block file (blocks.pack)
+ *
+ * All blocks live in one file; their byte offsets are kept in the manifest.
+ * Workers fault the pages of a block in and hand the GPU upload a pointer
+ * into the mapping, so a cache miss costs no open(), no heap allocation and
+ * no kernel->user copy.
+ */
+class BlockStore {
+public:
+  BlockStore() = default;
+  ~BlockStore();
+  BlockStore(const BlockStore&) = delete;
+  BlockStore& operator=(const BlockStore&) = delete;
+
+  /** @brief Map the packed file read-only */
+  bool open(const std::filesystem::path& path);
+
+  /** @brief Unmap the file */
+  void close();
+
+  /** @brief Size of the mapped file in bytes */
+  uint64_t size() const { return bytes; }
+
+  /** @brief Pointer to the data at the given byte offset */
+  const void* at(uint64_t offset) const { return base + offset; }
+
+  /** @brief Make the pages of a range resident (blocking, called by workers) */
+  void fault(uint64_t offset, uint64_t length) const;
+
+  /** @brief Hint the kernel that a range is needed soon (non-blocking) */
+  void willNeed(uint64_t offset, uint64_t length) const;
+
+private:
+  const unsigned char* base = nullptr;
+  uint64_t bytes = 0;
+  int fd = -1;
+  size_t pageSize = 4096;
+};
+
+#endif // BLOCKSTORE_H
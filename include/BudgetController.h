@@ -0,0 +1,68 @@
+//=============================================================================
+//
+//   BudgetController - Frame time driven slot and point budgets
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef BUDGETCONTROLLER_H
+#define BUDGETCONTROLLER_H
+
+constexpr float BUDGET_SMOOTHING = 0.2f;      // weight of the newest frame in the smoothed frame time
+constexpr float BUDGET_HYSTERESIS = 0.1f;     // no change within this share around the target
+constexpr float BUDGET_DECREASE = 0.85f;      // factor per step over the target
+constexpr float BUDGET_INCREASE = 0.05f;      // share of the range added per step under the target
+constexpr int BUDGET_COOLDOWN_FRAMES = 8;     // frames between two steps, the GPU lags a few frames behind
+constexpr float BUDGET_MIN_POINT_SCALE = 0.25f; // points per block never drop below this share of the LOD budget
+constexpr float BUDGET_MIN_SLOT_SHARE = 0.1f;   // slots never drop below this share of the capacity
+
+/**
+ * @brief Keeps the frame time near a target by moving two knobs
+ *
+ * The number of slots drawn and streamed per frame (the limit of the
+ * rasterizer) and a scale on the point budget of every block, which works
+ * on the progressive order: a smaller scale draws a uniform subsample.
+ * Over the target the points go first and the slots after them; under the
+ * target it runs backwards, so a short spike costs detail, not blocks.
+ * Steps are multiplicative down and additive up, with a cooldown so the
+ * effect of a step shows in the frame time before the next one.
+ */
+class BudgetController {
+public:
+  /**
+   * @brief Start with startSlots of [minSlots, maxSlots] and the full point budget
+   * @param targetMs frame time to hold, <= 0 disables the controller
+   */
+  void init(float targetMs, int minSlots, int maxSlots, int startSlots);
+
+  /** @brief Feed the time of the last frame, true if a budget changed */
+  bool update(float frameMs);
+
+  /** @brief true if a target is set */
+  bool enabled() const { return targetMs > 0.0f; }
+
+  /** @brief Slots drawn and streamed per frame */
+  int slots() const { return slotCount; }
+
+  /** @brief Capacity the slots may grow to */
+  int maxSlots() const { return slotMax; }
+
+  /** @brief Share of the point budget of a block, (0, 1] */
+  float pointScale() const { return scale; }
+
+  /** @brief Smoothed frame time */
+  float smoothedMs() const { return smoothed; }
+
+private:
+  float targetMs = 0.0f;
+  int slotMin = 1;
+  int slotMax = 1;
+  int slotCount = 1;
+  float scale = 1.0f;
+  float smoothed = 0.0f;
+  bool first = true;
+  int cooldown = 0;
+};
+
+#endif // BUDGETCONTROLLER_H
@@ -0,0 +1,67 @@
+//=============================================================================
+//
+//   BufferPool - Fixed set of preallocated buffers shared between threads
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "RingQueue.h"
+
+/**
+ * @brief Buffers that workers borrow and the main thread gives back
+ *
+ * All buffers are allocated once in init(); the free indices circulate
+ * through a RingQueue, so borrowing and returning never allocate or lock
+ * while buffers are available. acquire() sleeps while all are borrowed.
+ */
+class BufferPool {
+public:
+  /**
+   * @brief Allocate numBuffers buffers of bytes each, not thread-safe
+   * @param align alignment of every buffer, a power of two (O_DIRECT needs the page size)
+   */
+  void init(int numBuffers, size_t bytes_, size_t align = 64) {
+    bytes = (bytes_ + align - 1) / align * align;
+    storage.assign((size_t)numBuffers * bytes + align, 0);
+    uintptr_t p = reinterpret_cast<uintptr_t>(storage.data());
+    base = storage.data() + ((align - p % align) % align);
+    freeQ.init((size_t)numBuffers);
+    for (int i = 0; i < numBuffers; i++) freeQ.push(i);
+  }
+
+  /** @brief Borrow a buffer, blocking while none is free; -1 after stop() or without buffers */
+  int acquire() {
+    if (storage.empty()) return -1;
+    int idx = -1;
+    return freeQ.pop(idx) ? idx : -1;
+  }
+
+  /** @brief Give a borrowed buffer back */
+  void release(int idx) {
+    if (idx >= 0) freeQ.push(idx);
+  }
+
+  /** @brief Memory of a buffer */
+  void* data(int idx) { return base + (size_t)idx * bytes; }
+
+  /** @brief Size of one buffer */
+  size_t bufferBytes() const { return bytes; }
+
+  /** @brief Wake threads blocked in acquire(), they get -1 once no buffer is free */
+  void stop() { freeQ.stop(); }
+
+private:
+  std::vector<unsigned char> storage;
+  unsigned char* base = nullptr; // storage, aligned
+  size_t bytes = 0;
+  RingQueue<int> freeQ;
+};
+
+#endif // BUFFERPOOL_H
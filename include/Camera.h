@@ -73,6 +73,9 @@ public:
    */
   void changePose(const glm::vec3 &position, const glm::vec3 &target);
 
+  /** @brief Set position, Euler angles and zoom directly, e.g. from a recorded path */
+  void setPose(const glm::vec3 &position, float yaw, float pitch, float zoom);
+
   /**
    * @brief updates Yaw/Pitch based on the current position when watching the target
    */
@@ -0,0 +1,56 @@
+//=============================================================================
+//
+//   CameraPath - Recorded camera poses, one per frame
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef CAMERAPATH_H
+#define CAMERAPATH_H
+
+#include <vector>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include "Camera.h"
+
+/**
+ * @brief Camera pose of one frame
+ */
+struct CameraPose {
+  glm::vec3 position;
+  float yaw;
+  float pitch;
+  float zoom;
+};
+
+/**
+ * @brief Camera poses of consecutive frames
+ *
+ * Recorded from a session (interactive or test orbit) and replayed one pose
+ * per frame, so with the fixed time step of the render loop every run over
+ * the same path sees exactly the same views. Stored as text, one
+ * "x y z yaw pitch zoom" line per frame, '#' lines are comments.
+ */
+class CameraPath {
+public:
+  /** @brief Append the current pose of the camera */
+  void record(const Camera& camera);
+
+  /** @brief Set the camera to the pose of a frame, false past the end */
+  bool apply(size_t frame, Camera& camera) const;
+
+  /** @brief Read a path from a file */
+  bool load(const std::filesystem::path& path);
+
+  /** @brief Write the path to a file */
+  bool save(const std::filesystem::path& path) const;
+
+  /** @brief Number of frames */
+  size_t size() const { return poses.size(); }
+
+private:
+  std::vector<CameraPose> poses;
+};
+
+#endif // CAMERAPATH_H
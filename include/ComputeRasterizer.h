@@ -0,0 +1,92 @@
+//=============================================================================
+//
+//   ComputeRasterizer - Point rasterization with compute shaders and atomics
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef COMPUTERASTERIZER_H
+#define COMPUTERASTERIZER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+typedef enum {
+  RENDER_POINTS,  // glDrawArrays / glMultiDrawArrays with GL_POINTS
+  RENDER_COMPUTE  // ComputeRasterizer, needs GL 4.3
+} RenderBackend;
+
+/** @brief Name of a backend, as on the command line */
+const char* renderBackendName(RenderBackend backend);
+
+/** @brief Parse points|compute */
+bool parseRenderBackend(const std::string& name, RenderBackend& backend);
+
+/**
+ * @brief Rasterizes 1-pixel points with compute shaders instead of GL_POINTS
+ *
+ * Every point is projected by one invocation and written into a per-pixel
+ * framebuffer SSBO with atomicMin on (depth << 32 | color), so the nearest
+ * point wins without the fixed-function point pipeline. Without 64-bit
+ * atomics the same happens in two passes over 32-bit words (depth first,
+ * then the color of the point with that depth). resolve() copies color and
+ * depth into the default framebuffer, so later depth-tested draws and
+ * occlusion queries see the same depth as with GL_POINTS.
+ *
+ * Points are read straight from the vertex buffers (PointQ layout), with the
+ * quantization frame of a block from uniforms or from the region frames of
+ * the slot arena, like shader.vert.
+ */
+class ComputeRasterizer {
+public:
+  /**
+   * @brief Compile the shaders and allocate the framebuffer
+   * @param width framebuffer width in pixels
+   * @param height framebuffer height in pixels
+   * @return false if GL 4.3 is missing or a shader does not build
+   */
+  bool init(int width, int height, const char* computePath, const char* resolveVert, const char* resolveFrag);
+
+  /** @brief Delete all GL objects */
+  void destroy();
+
+  /** @brief Reallocate the framebuffer if the size changed */
+  void resize(int width, int height);
+
+  /** @brief Start a frame: clear the framebuffer, set the camera */
+  void begin(const glm::mat4& viewProj);
+
+  /** @brief Rasterize count points of one block buffer (in-core) */
+  void drawBuffer(GLuint vbo, int count, const glm::vec3& bb_min, const glm::vec3& bb_max);
+
+  /**
+   * @brief Rasterize ranges of the slot arena, one per draw
+   * @param vbo arena vertex buffer
+   * @param pointsPerRegion region size, the frames are read from texture unit 0
+   */
+  void drawRegions(GLuint vbo, int pointsPerRegion, const std::vector<GLint>& first, const std::vector<GLsizei>& count);
+
+  /** @brief Write the framebuffer into color and depth of the bound framebuffer */
+  void resolve();
+
+  bool uses64BitAtomics() const { return atomic64; }
+
+private:
+  /** @brief Dispatch over the draws in drawBuf, both passes without 64-bit atomics */
+  void dispatch(GLuint vbo, GLuint numDraws, GLuint maxCount);
+
+  GLuint rasterProg = 0, resolveProg = 0;
+  GLuint frameBuf = 0; // 2 words per pixel: color, depth bits
+  GLuint drawBuf = 0;  // Draw {first, count} list of a dispatch
+  GLuint emptyVAO = 0; // the resolve triangle comes from gl_VertexID
+  GLint locViewProj = -1, locSize = -1, locBlockMin = -1, locBlockExtent = -1;
+  GLint locPointsPerRegion = -1, locPass = -1, locResolveSize = -1;
+  int width = 0, height = 0;
+  bool atomic64 = false;
+  std::vector<GLuint> draws; // first, count pairs
+};
+
+#endif // COMPUTERASTERIZER_H
@@ -11,20 +11,33 @@
 
 #include <thread>
 #include <vector>
+#include <deque>
 #include <array>
 #include <filesystem>
 #include "Job.h"
 #include "Queue.h"
+#include "RingQueue.h"
+#include "BufferPool.h"
+#include "BlockReader.h"
+#include <memory>
+#include "JobScheduler.h"
 #include "Block.h"
 #include "Point.h"
 #include "FileStreamCache.h"
+#include "Manifest.h"
+#include "BlockStore.h"
+#include "Partitioner.h"
+#include "PlyFormat.h"
+#include "Profiler.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-constexpr size_t BATCH = 1u << 16; // e.g. 65536.
+constexpr size_t INGEST_CHUNK = 1u << 18;      // points per raw chunk in the ingestion pipeline
+constexpr size_t BBOX_SAMPLES = 64;            // evenly spaced samples for the bbox estimate
+constexpr size_t BBOX_SAMPLE_POINTS = 1u << 12; // points per bbox sample
 constexpr size_t CACHE_SIZE = 128;
-constexpr size_t FLUSH_POINTS = 4096;
-constexpr int NUM_WORKERS = 5;
+constexpr size_t RESULT_RING_MIN = 1024;       // cells of the result queue, at least
+constexpr int DECODE_BUFFERS_PER_WORKER = 2;    // decode buffers of compressed blocks, per worker
 
 class DataManager {
 
@@ -32,10 +45,16 @@ public:
   DataManager();
 
   /** @brief Initialize data manager and load PLY file */
-  bool init(const std::filesystem::path& plyPath, const std::filesystem::path& outDir_, bool isOOC_, glm::vec3& bb_min_, glm::vec3& bb_max_, std::vector<Block>& blocks, uint64_t& vertexCount);
+  bool init(const std::filesystem::path& plyPath, const std::filesystem::path& outDir_, bool isOOC_, bool forceRebuild, const PartitionConfig& partitionConfig_, int numWorkers, glm::vec3& bb_min_, glm::vec3& bb_max_, std::vector<Block>& blocks, uint64_t& vertexCount);
 
-  /** @brief Enqueue block loading job */
-  void enqueueBlock(const int& blockID, const int& slotIdx, const int& count, const bool& isSub);
+  /** @brief Load the blocks for in-core rendering in parallel, upload(index into blocks, points) runs on the caller */
+  bool loadInCore(const std::vector<Block>& blocks, const std::function<void(int, const PointQ*)>& upload);
+
+  /** @brief Enqueue block loading job for the points [first, first + count) of a block */
+  void enqueueBlock(const int& blockID, const int& slotIdx, const int& first, const int& count, const bool& isSub, float priority, uint32_t generation, void* staging = nullptr, int stagingIdx = -1);
+
+  /** @brief Re-key queued jobs, cancel the ones not refreshed to minGeneration; returns the number cancelled */
+  int rescheduleJobs(const std::function<void(Job&)>& refresh, uint32_t minGeneration);
 
   /** @brief Stop worker threads and cleanup */
   void quit();
@@ -43,48 +62,133 @@ public:
   /** @brief Get loaded block result from worker threads */
   void getResult(Result& out);
 
+  /** @brief Get loaded block result if one is ready, without blocking */
+  bool tryGetResult(Result& out);
+
+  /** @brief Give the decode buffer of a consumed result back to the workers */
+  void releaseResult(Result& r);
+
+  /** @brief Get manifest entry (offset, count, quantization bbox) of a block */
+  const BlockEntry& getBlockEntry(int blockID) const { return manifest.blocks[blockID]; }
+
+  /** @brief Hint that a block is likely to be requested soon */
+  void prefetchBlock(const int& blockID, const int& count);
+
   /** @brief Reset bounding box to initial state */
   void resetBBox();
 
+  /** @brief Number of blocks of the partition, including empty ones */
+  int getNumBlocks() const { return (int)num_blocks; }
+
+  /** @brief Profile worker queue wait and I/O into prof (set before init, nullptr disables) */
+  void setProfiler(ProfilerCPU* prof) { profiler = prof; }
+
+  /** @brief How workers read the block store (set before init) */
+  void setIO(const IOConfig& io_) { io = io_; }
+
 private:
 
+  /** @brief Take the oldest cancelled result that did not fit into resultQ */
+  bool popCancelled(Result& out);
+
+  /**
+   * @brief Queues of the ingestion pipeline: reader -> binners -> writer
+   *
+   * Chunks circulate between the filled and free queues, so the number of
+   * buffers (and the memory footprint) stays fixed for the whole pass.
+   */
+  struct IngestPipeline {
+    Queue<RawChunk> rawQ, freeRawQ;
+    Queue<BinnedChunk> binnedQ, freeBinnedQ;
+    const Partitioner* partitioner = nullptr; // maps positions to block ids
+    const VertexDecoder* decoder = nullptr;   // raw records to Points
+  };
+
+  /** @brief Per-binner block counts and tight bboxes, merged after the pass */
+  struct BinStats {
+    std::vector<int> counts;
+    std::vector<glm::vec3> bb_min, bb_max;
+  };
+
   // num blocks
   unsigned int num_blocks = 0;
+  PartitionConfig partitionConfig;
+  Partitioner partitioner;
+  std::vector<glm::vec3> samples; // bbox samples of readPLY(), input of the partitioner
 
-  // remember where binary vertex data begins in the .ply file
-  std::streampos dataStart;
+  // where the vertex records begin in the .ply file and how to read them
+  PlyLayout plyLayout;
+  VertexDecoder decoder;
   uint64_t vertexCount = 0;
 
   // FileStreamCache, Queue and workers
   FileStreamCache cache;
-  Queue<Job> jobQ;
-  Queue<Result> resultQ;
+  JobScheduler jobQ;
+  RingQueue<Result> resultQ; // lock-free, one result per job
+  std::deque<Result> cancelledQ; // cancelled results that found the ring full, main thread only
+  IOConfig io;
+  BufferPool loadPool;       // blocks that are decoded or read into memory, unless staged
   std::vector<std::thread> workers;
+  int numLoaders = 1;        // threads of loadInCore()
+  ProfilerCPU* profiler = nullptr;
   std::filesystem::path outDir;
+  Manifest manifest;
+  BlockStore store;
 
-  /** @brief Read PLY file and compute global bounding box */
+  /** @brief Reuse blocks of a previous run if the stored manifest matches the source */
+  bool restoreBlocks(const Manifest& source, glm::vec3& bb_min_, glm::vec3& bb_max_, std::vector<Block>& blocks, uint64_t& vertexCount_);
+
+  /** @brief Partition the PLY file into block files and write a new manifest */
+  bool partition(const std::filesystem::path& plyPath, const Manifest& source, glm::vec3& bb_min_, glm::vec3& bb_max_, std::vector<Block>& blocks, uint64_t& vertexCount_, bool isOOC_);
+
+  /** @brief Get manifest path in outDir */
+  std::filesystem::path manifestPath() const;
+
+  /** @brief Get packed block file path in outDir */
+  std::filesystem::path packPath() const;
+
+  /** @brief Quantize the per-block files into the packed file, fills the manifest offsets */
+  bool packBlocks();
+
+  /** @brief Reorder the points of a block so that every prefix is a uniform subsample */
+  static void progressiveOrder(std::vector<PointQ>& points);
+
+  /** @brief Read PLY header and estimate global bounding box from samples */
   bool readPLY(const std::filesystem::path& plyPath, glm::vec3& bb_min_, glm::vec3& bb_max_, uint64_t& vertexCount_);
 
-  /** @brief Create spatial blocks from point cloud */
-  bool createBlocks(const std::filesystem::path& plyPath, const glm::vec3& bb_min_, const glm::vec3& bb_max_, std::vector<Block>& blocks, bool isOOC_);
+  /** @brief Create spatial blocks from point cloud, refines bb_min_/bb_max_ to the exact bbox */
+  bool createBlocks(const std::filesystem::path& plyPath, glm::vec3& bb_min_, glm::vec3& bb_max_, std::vector<Block>& blocks, bool isOOC_);
+
+  /** @brief Ingestion: group raw chunks by block */
+  static void binnerMain(IngestPipeline& pipe, BinStats& stats);
+
+  /** @brief Ingestion: append binned chunks to the block files */
+  void writerMain(IngestPipeline& pipe, bool& ok);
 
-  /** @brief Get file path for block ID */
+  /** @brief Get file path of the temporary per-block file used during partitioning */
   std::filesystem::path pathFor(int id);
 
-  /** @brief Flush point buffer to disk */
-  void flush(int id, std::array<std::vector<Point>, NUM_BLOCKS> &outBuf);
+  /** @brief Append points to the file of block id */
+  bool flush(int id, const Point* points, size_t n);
 
   /** @brief Expand bounding box to include point */
   void bboxExpand(const glm::vec3 &p, glm::vec3 &bb_min_, glm::vec3 &bb_max);
 
   /** @brief Worker thread main function */
-  static void workerMain(int workerID, Queue<Job>& jobQ, Queue<Result>& resultQ);
+  static void workerMain(int workerID, JobScheduler& jobQ, RingQueue<Result>& resultQ, const BlockStore& store, BufferPool& loadPool, ProfilerCPU* profiler);
+
+  /** @brief Worker thread main function with a BlockReader, reads jobs in batches */
+  static void readerMain(int workerID, JobScheduler& jobQ, RingQueue<Result>& resultQ, std::unique_ptr<BlockReader> reader,
+                         BufferPool& loadPool, int depth, size_t maxStored, ProfilerCPU* profiler);
+
+  /** @brief Job for the points [first, first + count) of a block, without a destination */
+  Job jobFor(int blockID, int first, int count) const;
 
-  /** @brief Load block from file (for out-of-core rendering) */
-  static void loadBlock(const std::filesystem::path& path, const int & count, Result & r);
+  /** @brief Result of a job, without points yet */
+  static Result resultFor(const Job& job);
 
-  /** @brief Load block from file (for in-core rendering) */
-  static void loadBlock(const std::filesystem::path& path, const int & count, std::vector<Point>& points);
+  /** @brief Load block from the block store (for out-of-core rendering) */
+  static void loadBlock(const BlockStore& store, const Job& job, Result & r, BufferPool& loadPool, std::vector<unsigned char>& scratch);
 
 };
 #endif // DATAMANAGER_H
@@ -0,0 +1,147 @@
+//=============================================================================
+//
+//   EvictionPolicy - Replacement strategies for the subslots cache
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef EVICTIONPOLICY_H
+#define EVICTIONPOLICY_H
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+typedef enum {
+  CACHE_LRU,  // least recently used
+  CACHE_2Q,   // 2Q: one-time blocks age out of a FIFO, blocks seen again go to an LRU
+  CACHE_COST  // keep the blocks closest to the view frustum (Block::distanceToPlaneMin)
+} CachePolicy;
+
+/** @brief Name of a policy, as on the command line */
+const char* cachePolicyName(CachePolicy policy);
+
+/** @brief Parse lru|2q|cost */
+bool parseCachePolicy(const std::string& name, CachePolicy& policy);
+
+/**
+ * @brief Decides which cached block is evicted next
+ *
+ * The cache owns the slots, policies only see block ids.
+ */
+class EvictionPolicy {
+public:
+  virtual ~EvictionPolicy() = default;
+
+  /** @brief A block entered the cache */
+  virtual void insert(int blockID) = 0;
+
+  /** @brief A cached block was used */
+  virtual void touch(int blockID) = 0;
+
+  /** @brief A block left the cache; hit = it was taken back into a slot, not evicted */
+  virtual void erase(int blockID, bool hit) = 0;
+
+  /** @brief Block to evict next, -1 if empty */
+  virtual int victim() const = 0;
+
+  /** @brief Forget everything */
+  virtual void clear() = 0;
+
+  /**
+   * @brief Create a policy
+   * @param capacity cache capacity in slots
+   * @param scores per block id keep scores, higher is kept longer (CACHE_COST only)
+   */
+  static std::unique_ptr<EvictionPolicy> create(CachePolicy policy, size_t capacity, const std::vector<float>* scores);
+};
+
+/**
+ * @brief Recency list with O(1) touch and erase, shared by the policies
+ */
+class RecencyList {
+public:
+  void pushBack(int blockID);
+  void moveToBack(int blockID);
+  bool erase(int blockID);
+  bool contains(int blockID) const { return where.count(blockID) > 0; }
+  int front() const { return order.empty() ? -1 : order.front(); }
+  int popFront();
+  size_t size() const { return order.size(); }
+  void clear() { order.clear(); where.clear(); }
+  const std::list<int>& items() const { return order; }
+
+private:
+  std::list<int> order; // least recent first
+  std::unordered_map<int, std::list<int>::iterator> where;
+};
+
+/** @brief Least recently used */
+class LRUPolicy : public EvictionPolicy {
+public:
+  void insert(int blockID) override { lru.pushBack(blockID); }
+  void touch(int blockID) override { lru.moveToBack(blockID); }
+  void erase(int blockID, bool) override { lru.erase(blockID); }
+  int victim() const override { return lru.front(); }
+  void clear() override { lru.clear(); }
+
+private:
+  RecencyList lru;
+};
+
+/**
+ * @brief 2Q (Johnson & Shasha)
+ *
+ * New blocks enter the FIFO a1in. A block that is used again - taken back
+ * into a slot or re-inserted while its id is still in the ghost list a1out -
+ * goes to the LRU am. a1in is evicted first once it holds more than a
+ * quarter of the capacity, so blocks of a single sweep do not push out the
+ * ones a back-and-forth path keeps returning to.
+ */
+class TwoQueuePolicy : public EvictionPolicy {
+public:
+  explicit TwoQueuePolicy(size_t capacity);
+  void insert(int blockID) override;
+  void touch(int blockID) override;
+  void erase(int blockID, bool hit) override;
+  int victim() const override;
+  void clear() override;
+
+private:
+  /** @brief Put an id into the ghost list a1out */
+  void remember(int blockID);
+
+  size_t kin;  // a1in target size
+  size_t kout; // ghost list size
+  RecencyList a1in;
+  RecencyList am;
+  RecencyList a1out; // ids only
+};
+
+/**
+ * @brief Evicts the block with the lowest keep score
+ *
+ * Scores come from the renderer, per block id: the signed distance to the
+ * frustum of this frame (Block::distanceToPlaneMin), raised for blocks the
+ * predicted camera will see. Blocks far outside the view go first; ties go
+ * to the least recently inserted.
+ */
+class CostPolicy : public EvictionPolicy {
+public:
+  explicit CostPolicy(const std::vector<float>* scores_) : scores(scores_) {}
+  void insert(int blockID) override { entries.pushBack(blockID); }
+  void touch(int blockID) override { entries.moveToBack(blockID); }
+  void erase(int blockID, bool) override { entries.erase(blockID); }
+  int victim() const override;
+  void clear() override { entries.clear(); }
+
+private:
+  const std::vector<float>* scores;
+  RecencyList entries;
+};
+
+#endif // EVICTIONPOLICY_H
@@ -0,0 +1,94 @@
+//=============================================================================
+//
+//   FrameExporter - Asynchronous frame capture with PBO readback
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef FRAMEEXPORTER_H
+#define FRAMEEXPORTER_H
+
+#include <glad/glad.h>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Queue.h"
+
+constexpr int EXPORT_PBOS = 3;         // readbacks in flight, mapped this many frames later
+constexpr int EXPORT_IMAGES_PER_WRITER = 2; // CPU images per writer thread
+
+typedef enum {
+  EXPORT_PNG, // frame_%05d.png, encoded by the writers
+  EXPORT_RAW  // frame_%05d.rgba, top-down RGBA8 without header
+} ExportFormat;
+
+/** @brief Name of an export format, as on the command line */
+const char* exportFormatName(ExportFormat format);
+
+/** @brief Parse png|raw */
+bool parseExportFormat(const std::string& name, ExportFormat& format);
+
+/**
+ * @brief Captures frames without stalling the render thread
+ *
+ * capture() only starts a glReadPixels into one of EXPORT_PBOS pixel pack
+ * buffers and puts a fence behind it. The buffer is mapped when its slot
+ * comes round again, EXPORT_PBOS - 1 frames later, when the GPU is long done
+ * with it. The rows are copied out bottom-up into a free CPU image, which
+ * flips the frame on the way, and a writer thread encodes and writes it.
+ *
+ * Images circulate between a free and a filled queue, so memory stays fixed;
+ * if the writers fall behind, capture() waits for a free image.
+ */
+class FrameExporter {
+public:
+  /**
+   * @brief Create the pixel pack buffers and start the writers
+   * @param dir output directory, created if missing
+   * @param numWriters encoder threads, at least one
+   * @param readBuffer color buffer of the bound framebuffer to read, GL_BACK or an attachment
+   * @return false if the directory cannot be created
+   */
+  bool init(int width, int height, const std::filesystem::path& dir, ExportFormat format, int numWriters, GLenum readBuffer = GL_BACK);
+
+  /** @brief Read the frame into the next PBO; hands the frame of EXPORT_PBOS captures ago to the writers */
+  void capture(int frameIndex);
+
+  /** @brief Hand all pending readbacks to the writers and wait until everything is written */
+  void finish();
+
+  /** @brief finish(), then delete the buffers, needs the context */
+  void destroy();
+
+  /** @brief Frames handed to the writers so far */
+  int framesQueued() const { return queued; }
+
+private:
+  /** @brief One frame in CPU memory, top row first */
+  struct Image {
+    int frameIndex = -1;
+    std::vector<unsigned char> rgba;
+  };
+
+  /** @brief Map PBO i, copy it flipped into a free image and queue it */
+  void retire(int i);
+
+  /** @brief Encode and write images until stopped */
+  void writerMain();
+
+  int width = 0, height = 0;
+  std::filesystem::path dir;
+  ExportFormat format = EXPORT_PNG;
+  GLenum readBuffer = GL_BACK;
+  GLuint pbos[EXPORT_PBOS] = {};
+  GLsync fences[EXPORT_PBOS] = {};
+  int pboFrame[EXPORT_PBOS];  // frame index read into the PBO, -1 = none
+  int next = 0;               // PBO of the next capture, oldest readback
+  int queued = 0;
+  Queue<Image> filledQ, freeQ;
+  std::vector<std::thread> writers;
+};
+
+#endif // FRAMEEXPORTER_H
@@ -0,0 +1,75 @@
+//=============================================================================
+//
+//   FrustumCuller - Batched world space frustum culling of block bounds
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef FRUSTUMCULLER_H
+#define FRUSTUMCULLER_H
+
+#include <array>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Block.h"
+#include "Plane.h"
+
+constexpr int CULL_WIDTH = 8;                // blocks per batch, the bounds arrays are padded to it
+constexpr size_t CULL_PARALLEL_MIN = 8192;   // blocks per thread before culling is split
+
+/**
+ * @brief Per block results of a cull, indexed by blockID
+ */
+struct CullOutput {
+  std::vector<float> planeDist;         // smallest signed distance to the planes, >= 0 if visible
+  std::vector<float> cameraDist;        // block center to the camera
+  std::vector<float> frustumCenterDist; // block center to the center of the frustum
+};
+
+/**
+ * @brief Frustum culling over a structure-of-arrays copy of the block bounds
+ *
+ * The bounds never change after partitioning, so they are copied once into
+ * six float arrays. Each frame the six planes are extracted from proj * view
+ * in world space and tested against 8 (AVX), 4 (SSE) or 1 block at a time,
+ * without transforming any corners. Large block counts are split over
+ * threads.
+ */
+class FrustumCuller {
+public:
+  /**
+   * @brief Copy the bounds of the blocks
+   * @param blocks blocks in any order, results are indexed by their blockID
+   * @param numThreads threads used for large block counts, 1 = single threaded
+   */
+  void init(const std::vector<Block>& blocks, int numThreads);
+
+  /**
+   * @brief Test all blocks against the frustum of a camera
+   * @param proj projection matrix
+   * @param view view matrix, rigid
+   * @param zNear near plane
+   * @param zFar far plane
+   * @param out results, resized to the largest blockID + 1
+   */
+  void cull(const glm::mat4& proj, const glm::mat4& view, float zNear, float zFar, CullOutput& out) const;
+
+  /** @brief World space frustum planes of proj * view, normals point inside */
+  static std::array<Plane, 6> extractPlanes(const glm::mat4& viewProj);
+
+  size_t size() const { return ids.size(); }
+
+private:
+  /** @brief Cull the padded batch range [begin, end) */
+  void cullRange(const std::array<Plane, 6>& planes, const glm::vec3& eye, const glm::vec3& center,
+                 size_t begin, size_t end, CullOutput& out) const;
+
+  // bounds, padded to a multiple of CULL_WIDTH with empty boxes
+  std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+  std::vector<int> ids;      // blockID of each entry
+  int maxBlockID = -1;
+  int numThreads = 1;
+};
+
+#endif // FRUSTUMCULLER_H
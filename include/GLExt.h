@@ -0,0 +1,107 @@
+//=============================================================================
+//
+//   GLExt - OpenGL entry points and capabilities beyond the GL 3.3 glad loader
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef GLEXT_H
+#define GLEXT_H
+
+#include <glad/glad.h>
+#include <cstdint>
+
+// GL 4.4 / ARB_buffer_storage
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+extern PFNGLBUFFERSTORAGEPROC glext_glBufferStorage;
+#define glBufferStorage glext_glBufferStorage
+
+// GL 4.0 / ARB_draw_indirect, GL 4.3 / ARB_multi_draw_indirect
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+typedef void (APIENTRYP PFNGLMULTIDRAWARRAYSINDIRECTPROC)(GLenum mode, const void *indirect, GLsizei drawcount, GLsizei stride);
+extern PFNGLMULTIDRAWARRAYSINDIRECTPROC glext_glMultiDrawArraysIndirect;
+#define glMultiDrawArraysIndirect glext_glMultiDrawArraysIndirect
+
+// GL 4.3 / ARB_compute_shader, ARB_shader_storage_buffer_object, ARB_clear_buffer_object
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+typedef void (APIENTRYP PFNGLCLEARBUFFERDATAPROC)(GLenum target, GLenum internalformat, GLenum format, GLenum type, const void *data);
+extern PFNGLDISPATCHCOMPUTEPROC glext_glDispatchCompute;
+extern PFNGLMEMORYBARRIERPROC glext_glMemoryBarrier;
+extern PFNGLCLEARBUFFERDATAPROC glext_glClearBufferData;
+#define glDispatchCompute glext_glDispatchCompute
+#define glMemoryBarrier glext_glMemoryBarrier
+#define glClearBufferData glext_glClearBufferData
+
+// NVX_gpu_memory_info, ATI_meminfo: free video memory in KB
+#ifndef GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX
+#define GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX 0x9048
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#endif
+#ifndef GL_VBO_FREE_MEMORY_ATI
+#define GL_VBO_FREE_MEMORY_ATI 0x87FB
+#endif
+
+/**
+ * @brief Command layout of glMultiDrawArraysIndirect
+ */
+struct DrawArraysIndirectCommand {
+  GLuint count;
+  GLuint instanceCount;
+  GLuint first;
+  GLuint baseInstance;
+};
+
+/**
+ * @brief Optional features of the current context
+ */
+struct GLCaps {
+  int major = 0;
+  int minor = 0;
+  bool bufferStorage = false;     // GL 4.4 or ARB_buffer_storage
+  bool multiDrawIndirect = false; // GL 4.3 or ARB_multi_draw_indirect
+  bool compute = false;           // GL 4.3: compute shaders, SSBOs, glClearBufferData
+  bool atomic64 = false;          // ARB_gpu_shader_int64 + NV_shader_atomic_int64
+  bool memInfoNVX = false;        // NVX_gpu_memory_info
+  bool memInfoATI = false;        // ATI_meminfo
+};
+
+extern GLCaps glCaps;
+
+/** @brief Check if the current context exposes an extension */
+bool hasGLExtension(const char* name);
+
+/**
+ * @brief Load entry points that glad (GL 3.3 core) does not cover and fill glCaps
+ *
+ * Must be called after gladLoadGLLoader() with a current context.
+ */
+bool loadGLExtensions(GLADloadproc load);
+
+/**
+ * @brief Free video memory in bytes, false if the driver does not report it
+ *
+ * Needs NVX_gpu_memory_info or ATI_meminfo (free memory for buffers);
+ * other drivers, e.g. Mesa on Intel, do not tell.
+ */
+bool queryFreeVRAM(uint64_t& bytes);
+
+#endif // GLEXT_H
@@ -10,17 +10,27 @@
 #define JOB_H
 
 #include "Point.h"
-#include <filesystem>
+#include "BlockCodec.h"
+#include <cstdint>
+#include <vector>
 
 /**
  * @brief Job structure for worker threads
  */
 struct Job {
   int blockID; // block id
+  int first = 0; // index of the first point to load, > 0 when refining a loaded block
   int count;
   int slotIdx;
   bool loadToSlots;
-  std::filesystem::path path;
+  uint64_t offset; // byte offset of the first point in the packed file, of the block if compressed
+  const uint32_t* chunks = nullptr; // chunk table of a compressed block (manifest), nullptr if raw
+  Compression compression = COMPRESSION_NONE;
+  int blockCount = 0;      // points in the whole block, for the size of the last chunk
+  void* staging = nullptr; // persistently mapped staging region to write into, nullptr if unused
+  int stagingIdx = -1;
+  float priority = 0.0f;   // lower is more urgent: rank of the block in the rasterizer's sort order
+  uint32_t generation = 0; // frame the job was last confirmed in
 };
 
 /**
@@ -29,9 +39,31 @@ struct Job {
 struct Result {
   int blockID; // block id
   int slotIdx;
+  int first = 0;
   int count;
   bool loadToSlots;
+  const PointQ* points = nullptr; // into the mapped block store, nullptr if loading failed
+  int stagingIdx = -1;            // staging region holding a copy of the points, -1 if unused
+  int bufferIdx = -1;             // decode buffer holding the points, -1 if unused; see DataManager::releaseResult
+  bool cancelled = false;         // dropped by the scheduler before it was read
+};
+
+/**
+ * @brief Raw vertex records read from the PLY file (ingestion pipeline)
+ */
+struct RawChunk {
+  uint64_t n = 0;
+  std::vector<unsigned char> bytes; // n vertex records, see PlyLayout
+};
+
+/**
+ * @brief Points of one raw chunk, grouped by block (ingestion pipeline)
+ *
+ * Points of block id are points[offsets[id] .. offsets[id+1]).
+ */
+struct BinnedChunk {
   std::vector<Point> points;
+  std::vector<uint32_t> offsets;
 };
 
 #endif // JOB_H
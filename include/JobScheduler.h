@@ -0,0 +1,62 @@
+//=============================================================================
+//
+//   JobScheduler - Thread-safe priority queue of block loading jobs
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "Job.h"
+
+/**
+ * @brief Priority queue of jobs, most urgent (lowest priority value) first
+ *
+ * Same blocking behaviour as Queue: pop() sleeps while empty and returns
+ * false after stop(). In addition, queued jobs can be re-keyed and jobs that
+ * were not refreshed for the current generation can be dropped, so workers
+ * never spend I/O on blocks the rasterizer stopped asking for.
+ */
+class JobScheduler {
+public:
+  /** @brief Push a job and wake up one waiting worker */
+  void push(Job job);
+
+  /** @brief Pop the most urgent job, blocking while empty; false if stopped */
+  bool pop(Job& out);
+
+  /** @brief Pop up to max jobs in priority order, blocking until there is one; false if stopped */
+  bool popBatch(std::vector<Job>& out, size_t max);
+
+  /**
+   * @brief Re-key queued jobs and drop stale ones
+   * @param refresh called for every queued job, may update priority/slotIdx and
+   *                sets generation to keep the job alive
+   * @param minGeneration jobs with a lower generation after refresh are removed
+   * @param dropped receives the removed jobs
+   */
+  void reschedule(const std::function<void(Job&)>& refresh, uint32_t minGeneration, std::vector<Job>& dropped);
+
+  /** @brief Number of queued jobs */
+  size_t size();
+
+  /** @brief Signal all workers to stop waiting and exit */
+  void stop();
+
+private:
+  /** @brief Heap order: lower priority value first, older generation breaks ties */
+  static bool later(const Job& a, const Job& b);
+
+  std::vector<Job> heap_;
+  std::mutex m_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+};
+
+#endif // JOBSCHEDULER_H
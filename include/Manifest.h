@@ -0,0 +1,71 @@
+//=============================================================================
+//
+//   Manifest - Versioned index of the on-disk block store
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include <cstdint>
+#include <vector>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include "Partitioner.h"
+
+// bump whenever the manifest or block file layout changes
+constexpr uint32_t MANIFEST_VERSION = 6;
+
+/**
+ * @brief Per-block entry of the manifest
+ */
+struct BlockEntry {
+  int count = 0;
+  uint64_t offset = 0; // byte offset in blocks.pack
+  uint64_t bytes = 0;  // stored size, count * sizeof(PointQ) unless compressed
+  glm::vec3 bb_min, bb_max;
+  std::vector<uint32_t> chunks; // compressed: chunk offsets relative to offset, one past the last at the end
+};
+
+/**
+ * @brief Description of a partitioned point cloud in outDir
+ *
+ * Written after createBlocks() succeeded. On the next launch DataManager::init
+ * compares it with the source PLY and skips partitioning when it matches.
+ */
+struct Manifest {
+  uint32_t version = MANIFEST_VERSION;
+
+  // source PLY identity
+  uint64_t sourceSize = 0;
+  int64_t sourceMtime = 0;
+  uint64_t sourceHash = 0;
+
+  // partitioning
+  int32_t partitionMode = 0;
+  int32_t grid = 0;
+  uint64_t maxBlockPoints = 0;
+  int32_t compression = 0;
+  uint64_t vertexCount = 0;
+  glm::vec3 bb_min, bb_max;
+  std::vector<BlockEntry> blocks;
+
+  /** @brief Fill version, source identity and partition settings for the given PLY file */
+  bool describeSource(const std::filesystem::path& plyPath, const PartitionConfig& partition);
+
+  /** @brief Check if this manifest was built from the same source and settings */
+  bool matches(const Manifest& other) const;
+
+  /** @brief Write manifest to disk (via temporary file + rename) */
+  bool write(const std::filesystem::path& path) const;
+
+  /** @brief Read manifest from disk, false if missing or malformed */
+  bool read(const std::filesystem::path& path);
+};
+
+/** @brief Cheap content hash of a file: size, header and evenly spaced samples (FNV-1a) */
+uint64_t hashFileSampled(const std::filesystem::path& path);
+
+#endif // MANIFEST_H
@@ -0,0 +1,49 @@
+//=============================================================================
+//
+//   MotionPredictor - Extrapolates the camera pose from recent frames
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef MOTIONPREDICTOR_H
+#define MOTIONPREDICTOR_H
+
+#include <deque>
+#include <glm/glm.hpp>
+#include "Camera.h"
+
+constexpr size_t PREDICT_HISTORY = 8;      // frames the velocities are averaged over
+constexpr float PREDICT_MIN_SPEED = 1e-5f; // below this (per frame) the camera counts as still
+
+/**
+ * @brief Predicts where the camera will be a few frames ahead
+ *
+ * Linear velocity and yaw/pitch rates are the mean over the last
+ * PREDICT_HISTORY frames, so one jittery frame does not swing the
+ * prediction. Frames are fixed steps (fixedDt), so velocities are per frame.
+ */
+class MotionPredictor {
+public:
+  /** @brief Add the pose of this frame */
+  void observe(const Camera& camera);
+
+  /**
+   * @brief Camera extrapolated by the given number of frames
+   * @return false if there is no motion to extrapolate
+   */
+  bool predict(const Camera& camera, float frames, Camera& out) const;
+
+  /** @brief Forget the history, e.g. after a jump */
+  void reset() { history.clear(); }
+
+private:
+  struct Sample {
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+  };
+  std::deque<Sample> history;
+};
+
+#endif // MOTIONPREDICTOR_H
@@ -0,0 +1,73 @@
+//=============================================================================
+//
+//   OcclusionCuller - Occlusion queries on block bounding boxes
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef OCCLUSIONCULLER_H
+#define OCCLUSIONCULLER_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Block.h"
+#include "FrustumCuller.h"
+#include "Shader.h"
+
+constexpr int OCCLUSION_MAX_QUERIES = 512; // box queries issued per frame
+
+/**
+ * @brief Hides blocks inside the frustum whose boxes are behind drawn points
+ *
+ * After the blocks of a frame are drawn, the bounding boxes of blocks in the
+ * frustum are rendered without color and depth writes inside a
+ * GL_SAMPLES_PASSED query. Results are collected a frame or more later,
+ * without waiting for the GPU; a block stays occluded until one of its
+ * queries sees at least minSamples samples again. Blocks whose box contains
+ * the camera, and blocks without a finished query, count as visible.
+ */
+class OcclusionCuller {
+public:
+  /**
+   * @brief Create one query per block and the box shader
+   * @param blocks all blocks, queries are kept by blockID
+   * @param minSamples samples a box needs to count as visible
+   * @return false if the shader does not compile
+   */
+  bool init(const std::vector<Block>& blocks, const char* vertPath, const char* fragPath, int minSamples);
+
+  /** @brief Delete the GL objects, needs the context */
+  void destroy();
+
+  /** @brief Read the queries that finished, never waits */
+  void collect();
+
+  /**
+   * @brief Query the boxes of the blocks in the frustum against the depth of this frame
+   * @param cull frustum results of this frame, by blockID
+   * @param eye camera position in world space
+   * @param zNear near plane, boxes this close to the camera are not tested
+   */
+  void issue(const std::vector<Block>& blocks, const CullOutput& cull,
+             const glm::mat4& view, const glm::mat4& proj, const glm::vec3& eye, float zNear);
+
+  /** @brief true if the last finished query of the block saw too few samples */
+  bool isOccluded(int blockID) const { return blockID >= 0 && blockID < (int)occluded.size() && occluded[blockID]; }
+
+private:
+  Shader* shader = nullptr;
+  GLuint vao = 0;
+  GLint locBoxMin = -1;
+  GLint locBoxExtent = -1;
+  GLuint minSamples = 1;
+  std::vector<GLuint> queries;  // by blockID, 0 = no block
+  std::vector<uint8_t> pending; // query issued, result not read yet
+  std::vector<uint8_t> occluded;
+  std::vector<int> inFlight;    // blockIDs with pending queries
+  size_t cursor = 0;            // first block tested next frame, round robin
+};
+
+#endif // OCCLUSIONCULLER_H
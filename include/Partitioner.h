@@ -0,0 +1,87 @@
+//=============================================================================
+//
+//   Partitioner - Spatial subdivision of the point cloud into blocks
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef PARTITIONER_H
+#define PARTITIONER_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "BlockCodec.h"
+
+constexpr int DEFAULT_GRID = 10;                    // cells per axis of the uniform grid
+constexpr uint64_t DEFAULT_MAX_BLOCK_POINTS = 1u << 17; // target block size of the k-d partition
+constexpr int MAX_BLOCKS = 65536;                   // block ids are binned as uint16_t
+constexpr uint64_t KD_MIN_SAMPLES = 64;              // stop splitting below this many samples
+
+typedef enum {
+  PARTITION_GRID, // uniform GRID^3 cells over the bbox
+  PARTITION_KD    // k-d median splits until blocks hold at most maxBlockPoints
+} PartitionMode;
+
+/**
+ * @brief Partitioning settings, part of the block store identity
+ */
+struct PartitionConfig {
+  PartitionMode mode = PARTITION_KD;
+  int grid = DEFAULT_GRID;
+  uint64_t maxBlockPoints = DEFAULT_MAX_BLOCK_POINTS;
+  Compression compression = COMPRESSION_NONE; // layout of the points in blocks.pack
+};
+
+/**
+ * @brief Maps positions to block ids
+ *
+ * Built once per partitioning from the global bbox and the bbox samples of
+ * readPLY(). The uniform grid ignores the samples. The k-d tree splits the
+ * longest axis of a node at the median of its samples until the estimated
+ * point count of a node fits maxBlockPoints, so blocks end up roughly
+ * equal-sized regardless of how the points are distributed.
+ */
+class Partitioner {
+public:
+  /** @brief Build the partition, samples are reordered */
+  bool build(const PartitionConfig& config_, const glm::vec3& bb_min, const glm::vec3& bb_max,
+             std::vector<glm::vec3>& samples, uint64_t vertexCount);
+
+  /** @brief Number of blocks */
+  int numBlocks() const { return (int)cellMin.size(); }
+
+  /** @brief Block id of a position; positions outside the bbox go to border blocks */
+  int blockOf(const glm::vec3& p) const;
+
+  /** @brief Bounds of a block's cell */
+  void cellBounds(int id, glm::vec3& mn, glm::vec3& mx) const { mn = cellMin[id]; mx = cellMax[id]; }
+
+private:
+  /**
+   * @brief k-d tree node, leaf if axis < 0
+   */
+  struct Node {
+    int axis = -1;
+    float split = 0.0f;
+    int left = -1, right = -1; // children, or block id in left for a leaf
+  };
+
+  /** @brief Split samples [first, last) of a node recursively, returns the node index */
+  int buildNode(std::vector<glm::vec3>& samples, size_t first, size_t last,
+                const glm::vec3& mn, const glm::vec3& mx, uint64_t maxSamples);
+
+  PartitionConfig config;
+
+  // uniform grid
+  glm::vec3 frameMin;
+  glm::vec3 invCell;
+
+  // k-d tree
+  std::vector<Node> nodes;
+
+  std::vector<glm::vec3> cellMin, cellMax;
+};
+
+#endif // PARTITIONER_H
@@ -0,0 +1,106 @@
+//=============================================================================
+//
+//   PlyFormat - PLY header layout and vertex record decoders
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef PLYFORMAT_H
+#define PLYFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+#include "Point.h"
+
+constexpr size_t PLY_BATCH = 256; // points a decoder converts per column pass
+
+typedef enum {
+  PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16,
+  PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64
+} PlyType;
+
+typedef enum {
+  PLY_ASCII,
+  PLY_BINARY_LE,
+  PLY_BINARY_BE
+} PlyEncoding;
+
+/** @brief Bytes of a scalar of the type */
+size_t plyTypeSize(PlyType type);
+
+/** @brief Parse a PLY scalar type, old (uchar, float) and sized (uint8, float32) names */
+bool parsePlyType(const std::string& name, PlyType& type);
+
+/**
+ * @brief Scalar property of the vertex element
+ */
+struct PlyProperty {
+  std::string name;
+  PlyType type = PLY_FLOAT32;
+  size_t offset = 0; // byte offset in the vertex record
+};
+
+/**
+ * @brief Layout of the vertex records of a binary PLY file
+ *
+ * Any number and order of scalar properties is accepted; only x, y, z and
+ * the color (red/green/blue, r/g/b or diffuse_red/...) are read, the rest
+ * (normals, intensity, alpha, ...) is skipped by the stride. Elements in
+ * front of the vertices must not have list properties.
+ */
+struct PlyLayout {
+  PlyEncoding encoding = PLY_BINARY_LE;
+  uint64_t vertexCount = 0;
+  uint64_t dataOffset = 0;  // file offset of the first vertex record
+  size_t stride = 0;        // bytes per vertex record
+  std::vector<PlyProperty> properties;
+  int x = -1, y = -1, z = -1;  // indices into properties
+  int r = -1, g = -1, b = -1;  // -1 if the file has no color
+
+  /** @brief Parse the header from the start of the file, leaves the stream at dataOffset */
+  bool read(std::istream& in);
+
+  /** @brief true if the file has all three color channels */
+  bool hasColor() const { return r >= 0 && g >= 0 && b >= 0; }
+
+  /** @brief true if the records have to be byte swapped on this machine */
+  bool needsSwap() const;
+};
+
+/**
+ * @brief Converts vertex records to Points
+ *
+ * init() picks a decoder compiled for the types of the layout (position
+ * type x color type x byte order); layouts without one, e.g. integer
+ * positions or mixed position types, go through a generic decoder that
+ * switches on the type of every value. Colors are normalized to [0, 1]:
+ * integers by their maximum, floats are taken as they are. Files without
+ * color come out white.
+ */
+class VertexDecoder {
+public:
+  /** @brief Pick the decoder for a layout */
+  bool init(const PlyLayout& layout);
+
+  /** @brief Decode n records, safe to call from several threads */
+  void decode(const unsigned char* records, size_t n, Point* out) const;
+
+  /** @brief Name of the picked decoder, for the log */
+  const std::string& name() const { return decoderName; }
+
+  /** @brief Bytes per record */
+  size_t stride() const { return layout.stride; }
+
+  typedef void (*DecodeFn)(const PlyLayout& layout, const unsigned char* records, size_t n, Point* out);
+
+private:
+  PlyLayout layout;
+  DecodeFn fn = nullptr;
+  std::string decoderName;
+};
+
+#endif // PLYFORMAT_H
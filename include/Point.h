@@ -9,11 +9,13 @@
 #ifndef POINT_H
 #define POINT_H
 
+#include <cstdint>
+#include <cmath>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 /**
- * @brief Point structure for rendering
+ * @brief Full precision point, used while partitioning
  */
 struct Point {
   glm::vec3 pos;
@@ -24,24 +26,41 @@ static_assert(alignof(Point) == alignof(float));
 static_assert(sizeof(Point) == 24);
 
 /**
- * @brief Point structure as stored in PLY file
+ * @brief Compact point as stored in the block store and slot VBOs
+ *
+ * Position is quantized to 16 bits per axis relative to the block bbox and
+ * decoded in shader.vert (BlockMin + aPos * BlockExtent). Color is RGBA8.
  */
-#pragma pack(push, 1)
-struct FilePoint {
-  double x, y, z;        // File has 64-bit doubles, 8 bytes each
-  unsigned char r, g, b; // File has 8-bit integers
+struct PointQ {
+  uint16_t x, y, z;
+  uint16_t pad;          // keeps the color attribute 4-byte aligned
+  uint8_t r, g, b, a;
 };
-#pragma pack(pop)
-static_assert(sizeof(FilePoint) == 27);
+static_assert(sizeof(PointQ) == 12);
 
+constexpr float QUANT_MAX = 65535.0f;
 
+/** @brief Quantize a point into its block frame; scale = QUANT_MAX / block extent (0 for flat axes) */
+inline PointQ quantizePoint(const Point& p, const glm::vec3& bb_min, const glm::vec3& scale) {
+  glm::vec3 q = (p.pos - bb_min) * scale;
+  PointQ out;
+  out.x = (uint16_t)std::lround(std::fmin(std::fmax(q.x, 0.0f), QUANT_MAX));
+  out.y = (uint16_t)std::lround(std::fmin(std::fmax(q.y, 0.0f), QUANT_MAX));
+  out.z = (uint16_t)std::lround(std::fmin(std::fmax(q.z, 0.0f), QUANT_MAX));
+  out.pad = 0;
+  out.r = (uint8_t)std::lround(p.color.x * 255.0f);
+  out.g = (uint8_t)std::lround(p.color.y * 255.0f);
+  out.b = (uint8_t)std::lround(p.color.z * 255.0f);
+  out.a = 255;
+  return out;
+}
 
-/* #pragma pack(push, 1) */
-/* struct PointOOC { */
-/*   float x, y, z; // 4 bytes each */
-/*   uint8_t r, g, b; // 1 byte each */
-/* }; */
-/* #pragma pack(pop) */
-/* static_assert(sizeof(PointOOC) == 15); */
+/** @brief Per-axis quantization scale of a block bbox */
+inline glm::vec3 quantizeScale(const glm::vec3& bb_min, const glm::vec3& bb_max) {
+  glm::vec3 e = bb_max - bb_min;
+  return glm::vec3(e.x > 0.0f ? QUANT_MAX / e.x : 0.0f,
+                   e.y > 0.0f ? QUANT_MAX / e.y : 0.0f,
+                   e.z > 0.0f ? QUANT_MAX / e.z : 0.0f);
+}
 
 #endif
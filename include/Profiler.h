@@ -10,73 +10,292 @@
 #define PROFILER_H
 
 #include <cstdint>
+#include <cmath>
 #include <string>
-#include <unordered_map>
 #include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <fstream>
 #include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <limits.h>
+#include <limits>
 #include "Timer.h"
 
+/**
+ * @brief Profiled sections, known at compile time
+ *
+ * Add new sections before COUNT and give them a name in sectionName().
+ */
+enum class Section : uint8_t {
+  Frame,
+  Work1,
+  CullBlocks,
+  SortBlocks,
+  LoadOOC,
+  DrawOldBlocksOOC,
+  DrawLoadedBlocksOOC,
+  DrawInCore,
+  Progressive, // refinement of a still view
+  Occlusion,
+  Work2,
+  WorkerWait, // worker blocked on the job queue
+  WorkerIO,   // worker reading a block
+  COUNT
+};
+
+constexpr int SECTION_COUNT = (int)Section::COUNT;
+constexpr size_t TRACE_EVENTS_PER_THREAD = 1u << 18; // events kept per thread when tracing
+constexpr int HIST_BINS_PER_OCTAVE = 8;              // histogram resolution, ~9% per bin
+constexpr int HIST_BINS = 25 * HIST_BINS_PER_OCTAVE; // 1 us .. ~33 s
+
+/** @brief Display name of a section */
+inline const char* sectionName(Section s) {
+  static const char* names[SECTION_COUNT] = {
+    "Frame", "work1", "cullBlocks", "sortBlocks", "LoadOOC",
+    "drawOldBlocksOOC", "drawLoadedBlocksOOC", "DrawInCore", "progressive", "occlusion", "work2",
+    "workerWait", "workerIO"
+  };
+  return names[(int)s];
+}
+
 /**
  * @brief CPU profiler for measuring execution time
+ *
+ * Every thread records into its own ThreadLog, created on first use, so the
+ * hot path takes no lock: per-section stats are plain fields of the owning
+ * thread, trace events go into a preallocated buffer that only the owner
+ * appends to (the count is published with release semantics, readers load it
+ * with acquire). Stats of all threads are merged when printing.
  */
 struct ProfilerCPU {
 
-  /** @brief Statistics for a profiled section */
+  /** @brief Statistics for a profiled section, with a log-scale histogram for percentiles */
   struct Stat {
     float total_ms = 0.0f;
     float current_ms = 0.0f;
     int calls = 0;
     float max_ms = 0.0f;
     float min_ms = std::numeric_limits<float>::max();
+    std::array<uint32_t, HIST_BINS> hist{};
+
+    /** @brief Add one measurement */
+    void add(float ms) {
+      total_ms += ms;
+      current_ms = ms;
+      calls += 1;
+      max_ms = std::max(max_ms, ms);
+      min_ms = std::min(min_ms, ms);
+      hist[bin(ms)]++;
+    }
+
+    /** @brief Merge another stat into this one */
+    void merge(const Stat& o) {
+      total_ms += o.total_ms;
+      calls += o.calls;
+      max_ms = std::max(max_ms, o.max_ms);
+      min_ms = std::min(min_ms, o.min_ms);
+      for (int i = 0; i < HIST_BINS; ++i) hist[i] += o.hist[i];
+    }
+
+    /** @brief Approximate percentile in ms (upper edge of the bin, capped by max) */
+    float percentile(float p) const {
+      if (calls == 0) return 0.0f;
+      uint64_t target = (uint64_t)std::ceil(p * (float)calls);
+      uint64_t seen = 0;
+      for (int i = 0; i < HIST_BINS; ++i) {
+        seen += hist[i];
+        if (seen >= target && seen > 0) {
+          float edge = 1e-3f * std::exp2((float)(i + 1) / HIST_BINS_PER_OCTAVE);
+          return std::min(edge, max_ms);
+        }
+      }
+      return max_ms;
+    }
+
+    /** @brief Histogram bin of a duration */
+    static int bin(float ms) {
+      float us = ms * 1000.0f;
+      if (us <= 1.0f) return 0;
+      int b = (int)(std::log2(us) * HIST_BINS_PER_OCTAVE);
+      return std::min(std::max(b, 0), HIST_BINS - 1);
+    }
+  };
+
+  /** @brief One complete section, for the trace */
+  struct Event {
+    uint64_t begin_ns;
+    uint64_t dur_ns;
+    Section section;
+  };
+
+  /** @brief Everything one thread recorded */
+  struct ThreadLog {
+    int tid = 0;
+    std::string name;
+    std::array<Stat, SECTION_COUNT> stats;
+    std::vector<Event> events;       // fixed capacity, only the owner writes
+    std::atomic<size_t> eventCount{0};
+    size_t droppedEvents = 0;
   };
 
-  std::unordered_map<std::string, Stat> stats;
+  /** @brief Keep trace events (call before threads start recording) */
+  void enableTrace() { tracing = true; }
 
-  /** @brief Add timing measurement for a named section */
-  void add(const std::string& name, float ms) {
-    auto& s = stats[name];
-    s.total_ms += ms;
-    s.current_ms = ms;
-    s.calls += 1;
-    s.max_ms = std::max(s.max_ms, ms);
-    s.min_ms = std::min(s.min_ms, ms);
+  /** @brief Nanoseconds since the profiler was created */
+  uint64_t now() const {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(TimerCPU::clock::now() - epoch).count();
   }
 
-  /** @brief Print top N profiled sections and reset stats */
-  void end_frame_and_print(uint32_t topN = 12) {
-    struct Row { std::string name; Stat s; };
-    std::vector<Row> rows;
-    rows.reserve(stats.size());
-    for (auto& kv : stats) rows.push_back({kv.first, kv.second});
+  /** @brief Record a finished section of the calling thread */
+  void record(Section s, uint64_t begin_ns, uint64_t end_ns) {
+    ThreadLog& log = local();
+    log.stats[(int)s].add((float)((double)(end_ns - begin_ns) * 1e-6));
+    if (!log.events.empty()) {
+      size_t n = log.eventCount.load(std::memory_order_relaxed);
+      if (n < log.events.size()) {
+        log.events[n] = { begin_ns, end_ns - begin_ns, s };
+        log.eventCount.store(n + 1, std::memory_order_release);
+      } else {
+        log.droppedEvents++;
+      }
+    }
+  }
+
+  /** @brief Name the calling thread in the trace */
+  void setThreadName(const std::string& name) { local().name = name; }
+
+  /** @brief Stat of a section on the calling thread */
+  const Stat& stat(Section s) { return local().stats[(int)s]; }
+
+  /**
+   * @brief Print all profiled sections, merged over threads, and reset stats
+   *
+   * Call once all recording threads are done.
+   * @param gpu optional GPU stats of the same sections (see ProfilerGPU), printed alongside
+   */
+  void end_frame_and_print(uint32_t topN = 12, std::array<Stat, SECTION_COUNT>* gpu = nullptr) {
+    std::array<Stat, SECTION_COUNT> merged;
+    {
+      std::lock_guard<std::mutex> lk(m);
+      for (auto& log : logs) {
+        for (int i = 0; i < SECTION_COUNT; ++i) merged[i].merge(log->stats[i]);
+        log->stats = std::array<Stat, SECTION_COUNT>(); // reset per frame
+      }
+    }
 
-    std::sort(rows.begin(), rows.end(), [](auto& a, auto& b){
-      return a.s.total_ms > b.s.total_ms;
+    std::vector<int> rows;
+    for (int i = 0; i < SECTION_COUNT; ++i) if (merged[i].calls > 0) rows.push_back(i);
+    std::sort(rows.begin(), rows.end(), [&](int a, int b){
+      return merged[a].total_ms > merged[b].total_ms;
     });
 
-    std::cout << "---- CPU Profiler ----\n";
+    std::cout << (gpu ? "---- CPU / GPU Profiler ----\n" : "---- CPU Profiler ----\n");
     std::cout << std::left << std::setw(20) << "Name"
               << std::right << std::setw(12) << "Total(ms)"
               << std::setw(8) << "Calls"
-              << std::setw(12) << "Avg(ms)"
-              << std::setw(12) << "Max(ms)"
-              << std::setw(12) << "Min(ms)" << "\n";
-    std::cout << std::string(70, '-') << "\n";
-
-    for (uint32_t i = 0; i < std::min<uint32_t>(topN, (uint32_t)rows.size()); ++i) {
-      const auto& r = rows[i];
-      double avg = r.s.total_ms / std::max(1, r.s.calls);
-      std::cout << std::left << std::setw(20) << r.name
+              << std::setw(10) << "Avg(ms)"
+              << std::setw(10) << "p50"
+              << std::setw(10) << "p95"
+              << std::setw(10) << "p99"
+              << std::setw(10) << "Max(ms)";
+    if (gpu) {
+      std::cout << std::setw(10) << "GPU Avg" << std::setw(10) << "GPU p95";
+    }
+    std::cout << "\n";
+    std::cout << std::string(gpu ? 110 : 90, '-') << "\n";
+
+    for (uint32_t k = 0; k < std::min<uint32_t>(topN, (uint32_t)rows.size()); ++k) {
+      const Stat& s = merged[rows[k]];
+      double avg = s.total_ms / std::max(1, s.calls);
+      std::cout << std::left << std::setw(20) << sectionName((Section)rows[k])
                 << std::right << std::fixed << std::setprecision(3)
-                << std::setw(12) << r.s.total_ms
-                << std::setw(8) << r.s.calls
-                << std::setw(12) << avg
-                << std::setw(12) << r.s.max_ms
-                << std::setw(12) << r.s.min_ms << "\n";
+                << std::setw(12) << s.total_ms
+                << std::setw(8) << s.calls
+                << std::setw(10) << avg
+                << std::setw(10) << s.percentile(0.50f)
+                << std::setw(10) << s.percentile(0.95f)
+                << std::setw(10) << s.percentile(0.99f)
+                << std::setw(10) << s.max_ms;
+      if (gpu) {
+        const Stat& g = (*gpu)[rows[k]];
+        if (g.calls > 0) {
+          std::cout << std::setw(10) << g.total_ms / g.calls << std::setw(10) << g.percentile(0.95f);
+        } else {
+          std::cout << std::setw(10) << "-" << std::setw(10) << "-";
+        }
+      }
+      std::cout << "\n";
+    }
+    if (gpu) *gpu = std::array<Stat, SECTION_COUNT>();
+  }
+
+  /**
+   * @brief Write the trace events of all threads as Chrome trace JSON
+   *
+   * Open in chrome://tracing or https://ui.perfetto.dev.
+   */
+  bool write_trace(const std::string& path) {
+    std::ofstream os(path, std::ios::trunc);
+    if (!os.is_open()) {
+      std::cerr << "Error: Could not write trace file: " << path << std::endl;
+      return false;
+    }
+    std::lock_guard<std::mutex> lk(m);
+    os << "{\"traceEvents\":[\n";
+    bool first = true;
+    size_t dropped = 0;
+    for (auto& log : logs) {
+      if (!first) os << ",\n";
+      first = false;
+      os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << log->tid
+         << ",\"args\":{\"name\":\"" << (log->name.empty() ? "thread " + std::to_string(log->tid) : log->name) << "\"}}";
+      size_t n = log->eventCount.load(std::memory_order_acquire);
+      for (size_t i = 0; i < n; ++i) {
+        const Event& e = log->events[i];
+        os << ",\n{\"name\":\"" << sectionName(e.section) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << log->tid
+           << std::fixed << std::setprecision(3)
+           << ",\"ts\":" << (double)e.begin_ns * 1e-3 << ",\"dur\":" << (double)e.dur_ns * 1e-3 << "}";
+      }
+      dropped += log->droppedEvents;
+    }
+    os << "\n]}\n";
+    if (dropped > 0) {
+      std::cout << "Trace buffers were full, " << dropped << " events dropped." << std::endl;
+    }
+    std::cout << "Trace written to " << path << std::endl;
+    return true;
+  }
+
+private:
+  TimerCPU::clock::time_point epoch = TimerCPU::clock::now();
+  bool tracing = false;
+  std::mutex m; // guards logs, taken once per thread and when printing
+  std::vector<std::unique_ptr<ThreadLog>> logs;
+  const uint64_t id = nextID(); // unlike the address, never reused by a later profiler
+
+  /** @brief Unique id of a new profiler */
+  static uint64_t nextID() {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+  }
+
+  /** @brief Log of the calling thread, registered on first use */
+  ThreadLog& local() {
+    thread_local ThreadLog* log = nullptr;
+    thread_local uint64_t owner = 0;
+    if (owner != id) {
+      std::lock_guard<std::mutex> lk(m);
+      logs.push_back(std::make_unique<ThreadLog>());
+      log = logs.back().get();
+      log->tid = (int)logs.size();
+      if (tracing) log->events.resize(TRACE_EVENTS_PER_THREAD);
+      owner = id;
     }
-    stats.clear(); // reset per frame
+    return *log;
   }
 };
 
@@ -85,31 +304,28 @@ struct ProfilerCPU {
  */
 struct ScopedProfile {
   ProfilerCPU& prof;
-  TimerCPU t;
-  std::string name;
-  ScopedProfile(ProfilerCPU& p, std::string n) : prof(p), name(std::move(n)) {}
-  ~ScopedProfile() { prof.add(name, t.ms()); }
+  Section section;
+  uint64_t t0;
+  ScopedProfile(ProfilerCPU& p, Section s) : prof(p), section(s), t0(p.now()) {}
+  ~ScopedProfile() { prof.record(section, t0, prof.now()); }
 };
 
 
 // how to use
-/* CpuProfiler gCpuProf; */
+/* ProfilerCPU gCpuProf; */
 
 /* void RenderFrame() { */
-/*   CPU_PROFILE(gCpuProf, "Frame"); */
+/*   CPU_PROFILE(gCpuProf, Section::Frame); */
 
-/*   { CPU_PROFILE(gCpuProf, "Culling");   DoCulling(); } */
-/*   { CPU_PROFILE(gCpuProf, "Shadow");    RenderShadow(); } */
-/*   { CPU_PROFILE(gCpuProf, "GBuffer");   RenderGBuffer(); } */
-/*   { CPU_PROFILE(gCpuProf, "Lighting");  RenderLighting(); } */
-/*   { CPU_PROFILE(gCpuProf, "Post");      RenderPost(); } */
+/*   { CPU_PROFILE(gCpuProf, Section::CullBlocks); cullBlocks(); } */
+/*   { CPU_PROFILE(gCpuProf, Section::SortBlocks); sortBlocks(); } */
 
-/*   gCpuProf.end_frame_and_print(); // 혹은 60프레임마다 출력 */
+/*   gCpuProf.end_frame_and_print(); */
 /* } */
 
 // Macros
 #define CONCAT_INNER(a,b) a##b
 #define CONCAT(a,b) CONCAT_INNER(a,b)
-#define CPU_PROFILE(prof, name) ScopedProfile CONCAT(_ScopedProfile_, __LINE__)(prof, name)
+#define CPU_PROFILE(prof, section) ScopedProfile CONCAT(_ScopedProfile_, __LINE__)(prof, section)
 
 #endif // PROFILER_H
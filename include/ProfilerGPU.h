@@ -0,0 +1,134 @@
+//=============================================================================
+//
+//   ProfilerGPU - GPU profiling with timestamp queries
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef PROFILERGPU_H
+#define PROFILERGPU_H
+
+#include <glad/glad.h>
+#include <array>
+#include <vector>
+#include "Profiler.h"
+
+constexpr int GPU_QUERY_FRAMES = 4; // frames in flight before results are read back
+
+/**
+ * @brief GPU profiler for measuring execution time of sections on the GPU
+ *
+ * Each section is a pair of GL_TIMESTAMP queries (GL_TIME_ELAPSED cannot
+ * nest, the sections do). Queries of a frame are read back GPU_QUERY_FRAMES
+ * frames later, when the GPU is long done with them, so reading never
+ * stalls; if a frame is still not finished by then its samples are dropped.
+ * Results go into the same Stat as ProfilerCPU, indexed by Section.
+ */
+struct ProfilerGPU {
+
+  std::array<ProfilerCPU::Stat, SECTION_COUNT> stats;
+  int droppedFrames = 0;
+
+  /** @brief Start a section, returns its handle for end() */
+  int begin(Section section) {
+    Frame& f = frames[cur];
+    f.sections.push_back({section, query(f), -1});
+    return (int)f.sections.size() - 1;
+  }
+
+  /** @brief End a section started in the current frame */
+  void end(int section) {
+    Frame& f = frames[cur];
+    f.sections[section].end = query(f);
+  }
+
+  /** @brief Close the current frame and collect the oldest one without waiting */
+  void end_frame() {
+    cur = (cur + 1) % GPU_QUERY_FRAMES;
+    collect(frames[cur], false);
+  }
+
+  /** @brief Collect all frames still in flight, waiting for the GPU */
+  void flush() {
+    for (int k = 1; k <= GPU_QUERY_FRAMES; ++k) {
+      collect(frames[(cur + k) % GPU_QUERY_FRAMES], true);
+    }
+  }
+
+  /** @brief Delete all query objects (needs the GL context) */
+  void destroy() {
+    for (Frame& f : frames) {
+      if (!f.queries.empty()) glDeleteQueries((GLsizei)f.queries.size(), f.queries.data());
+      f.queries.clear();
+      f.sections.clear();
+      f.used = 0;
+    }
+  }
+
+private:
+  /** @brief A section of one frame, indices into Frame::queries */
+  struct Range { Section section; int begin; int end; };
+
+  /** @brief Queries issued in one frame, the objects are reused */
+  struct Frame {
+    std::vector<GLuint> queries;
+    size_t used = 0;
+    std::vector<Range> sections;
+  };
+
+  Frame frames[GPU_QUERY_FRAMES];
+  int cur = 0;
+
+  /** @brief Issue a timestamp query in the given frame, returns its index */
+  int query(Frame& f) {
+    if (f.used == f.queries.size()) {
+      GLuint q = 0;
+      glGenQueries(1, &q);
+      f.queries.push_back(q);
+    }
+    glQueryCounter(f.queries[f.used], GL_TIMESTAMP);
+    return (int)f.used++;
+  }
+
+  /** @brief Read back the sections of a frame and recycle its queries */
+  void collect(Frame& f, bool wait) {
+    if (f.used > 0 && !wait) {
+      // queries complete in order, so the last one tells for the whole frame
+      GLint available = 0;
+      glGetQueryObjectiv(f.queries[f.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+      if (!available) {
+        droppedFrames++;
+        f.sections.clear();
+        f.used = 0;
+        return;
+      }
+    }
+    for (const Range& s : f.sections) {
+      if (s.end < 0) continue;
+      GLuint64 t0 = 0, t1 = 0;
+      glGetQueryObjectui64v(f.queries[s.begin], GL_QUERY_RESULT, &t0);
+      glGetQueryObjectui64v(f.queries[s.end], GL_QUERY_RESULT, &t1);
+      stats[(int)s.section].add((float)((double)(t1 - t0) * 1e-6));
+    }
+    f.sections.clear();
+    f.used = 0;
+  }
+};
+
+/**
+ * @brief RAII wrapper for automatic GPU scope timing
+ */
+struct ScopedProfileGPU {
+  ProfilerGPU& prof;
+  int section;
+  ScopedProfileGPU(ProfilerGPU& p, Section s) : prof(p), section(p.begin(s)) {}
+  ~ScopedProfileGPU() { prof.end(section); }
+};
+
+// Macros
+#define GPU_PROFILE(prof, section) ScopedProfileGPU CONCAT(_ScopedProfileGPU_, __LINE__)(prof, section)
+// same section on the CPU and the GPU
+#define PROFILE(cpu, gpu, section) CPU_PROFILE(cpu, section); GPU_PROFILE(gpu, section)
+
+#endif // PROFILERGPU_H
@@ -13,15 +13,38 @@
 #include <GLFW/glfw3.h>
 #include "Shader.h"
 #include "Camera.h"
-#include "Plane.h"
+#include "FrustumCuller.h"
+#include "OcclusionCuller.h"
+#include "ComputeRasterizer.h"
+#include "FrameExporter.h"
 #include "Block.h"
 #include "Slot.h"
 #include "Profiler.h"
+#include "ProfilerGPU.h"
 #include "SubslotsCache.h"
+#include "Residency.h"
 #include "DataManager.h"
+#include "StagingRing.h"
+#include "SlotArena.h"
+#include "RasterizerConfig.h"
+#include "BenchStats.h"
+#include "CameraPath.h"
+#include "MotionPredictor.h"
+#include "BudgetController.h"
 #include <vector>
+#include <unordered_set>
 #include <filesystem>
 
+constexpr int PREFETCH_HINTS = 16; // blocks after limit hinted to the block store per frame
+constexpr int RERANK_MAX_SHIFTS = 8; // moves per ranked block before sortBlocks() sorts from scratch
+constexpr int HEADLESS_FRAMES = 2;   // frames the GPU may lag behind in headless mode, like a swap chain
+constexpr int LOD_MIN_POINTS = 1024;   // never go coarser than this many points per block
+constexpr float LOD_REFINE_STEP = 1.25f; // refine a slot once its budget grew by this factor
+constexpr int PREDICT_MAX_JOBS = 4;      // prefetch loads of predicted blocks per frame
+constexpr int STILL_SETTLE_FRAMES = 2;   // still frames before culling is skipped, covers the occlusion query latency
+constexpr int PROGRESSIVE_REGIONS = 8;   // spare arena regions that stream blocks past limit into a still view
+constexpr int PROGRESSIVE_SLOT = -2;     // slotIdx of progressive jobs
+
 class Rasterizer
 {
 public:
@@ -29,27 +52,16 @@ public:
    * @brief Initialize the rasterizer with rendering parameters
    * @return true if initialization succeeds, false otherwise
    */
-  bool init(const std::filesystem::path& plyPath,
-            const std::filesystem::path& outDir,
-            const std::filesystem::path& shader_vert,
-            const std::filesystem::path& shader_frag,
-            bool isTest_,
-            bool isOOC_,
-            bool isCache_,
-            bool isExport_,
-            unsigned int window_width_,
-            unsigned int window_height_,
-            float z_near_,
-            float z_far_,
-            float rotateAngle_,
-            float distanceFactor_,
-            float slotFactor_);
+  bool init(const RasterizerConfig& config);
 
   /**
    * @brief Main render loop
    */
   void render();
 
+  /** @brief Results of the last render(), measured frames only */
+  const BenchStats& getBenchStats() const { return bench; }
+
   Rasterizer();
   ~Rasterizer();
 
@@ -66,6 +78,8 @@ private:
   bool setupCameraPose();
   /** @brief Setup input callbacks */
   bool setupCallbacks();
+  /** @brief Create the offscreen framebuffer of headless and progressive mode */
+  bool setupOffscreen();
   /** @brief Initialize data manager */
   bool setupDataManager();
   /** @brief Filter out empty blocks */
@@ -97,78 +111,191 @@ private:
   // Slot management
   /** @brief Update slot with given block ID */
   bool updateSlotByBlockID(int blockID, int targetIdx);
-  /** @brief Check if block is already loaded in a slot */
-  bool isBlockInSlot(int blockID);
+  /** @brief Find the slot that is waiting for the given block, -1 if none */
+  int findLoadingSlot(int blockID, int hintIdx);
+  /** @brief Find the loaded slot of a block whose upload ends at first, -1 if none */
+  int findRefiningSlot(int blockID, int hintIdx, int first);
+  /** @brief Hand a slot over to a new block and mark it as loading */
+  void assignSlot(int slotIdx, int blockID, int count);
   float slotFactor; // take slotFactor of total blocks to build slots, e.g. 20%.
+  float subslotRatio; // subslots per slot
+  CachePolicy cachePolicy = CACHE_LRU;
+  std::vector<float> blockScore; // keep score per block id for CACHE_COST, see cullBlocks()
+  int numWorkers;
+  IOConfig io;
   int num_slots = INT_MAX;
   int num_subSlots = INT_MAX;
   int num_points_per_slot = INT_MAX;
+  SlotArena arena; // backs all slots and subslots
 
   // Block rendering
   /** @brief Clear color and depth buffers */
   void clear();
   /** @brief Set view matrix in shader */
   void setShaderView();
+  /** @brief Set the quantization frame of the block about to be drawn */
+  void setBlockFrame(const glm::vec3& bb_min_, const glm::vec3& bb_max_);
+  GLint locBlockMin = -1;
+  GLint locBlockExtent = -1;
   /** @brief Cull blocks against view frustum */
   void cullBlocks();
-  /** @brief sort blocks */
+  /** @brief Rank the blocks: sort the prefix that is read this frame */
   void sortBlocks();
+  /** @brief Re-sort last frame's ranking in place, false if it changed too much */
+  bool rerankIncremental(int k);
+  /** @brief Block of the given rank, in order for ranks < rankCount */
+  Block& ranked(int i) { return blocks[ranking[i].index]; }
+  struct RankKey {
+    uint64_t key;
+    int index; // into blocks
+  };
+  std::vector<RankKey> ranking; // best first, the first rankCount are sorted
+  int rankCount = 0;
   /** @brief Draw blocks in in-core mode */
   void drawBlocks();
   /** @brief Load blocks in out-of-core mode */
   void loadBlocksOOC();
-  /** @brief Enqueue single block for loading */
-  void loadBlock(const int& blockID, const int& slotIdx, const int& count, const bool& loadToSlots);
+  /** @brief Enqueue single block for loading, false if no staging region is free */
+  bool loadBlock(const int& blockID, const int& slotIdx, const int& first, const int& count, const bool& loadToSlots, float priority);
+  /** @brief Request the next points of a loaded slot if its LOD budget grew */
+  void refineSlot(int slotIdx);
+
+  // Predictive prefetch
+  /** @brief Load blocks visible from the predicted camera into subslots */
+  void prefetchPredicted();
+  MotionPredictor predictor;
+  bool isPrefetch = false;
+  int prefetchFrames = 30;
+  std::unordered_set<int> prefetchPending; // predicted blocks in flight
+  std::unordered_set<int> prefetched;      // predicted blocks cached, not hit yet
+  int prefetchLoads = 0;
+  int prefetchHits = 0;
+
+  // Level of detail
+  /** @brief Point budget of a block from its projected size on screen */
+  int lodBudget(const Block& block) const;
+  float lodDensity = 1.0f; // points per covered pixel
+  float focalPx = 1.0f;    // focal length in pixels of the projection
+  /** @brief Re-key queued jobs to this frame's order and cancel the ones no slot waits for */
+  void rescheduleJobs();
   /** @brief Draw existing blocks already in slots */
   void drawOldBlocksOOC();
   /** @brief Draw newly loaded blocks from worker threads */
   void drawLoadedBlocksOOC();
+  /** @brief Upload a finished job into its slot or subslot */
+  void uploadResult(Result& r);
+  /** @brief Copy the points of a result into an arena region (staging copy or glBufferSubData) */
+  void uploadPoints(int region, const Result& r);
+  /** @brief Give the staging region of a dropped result back */
+  void discardResult(const Result& r);
+  /** @brief Undo what a failed or cancelled job reserved */
+  void dropResult(const Result& r);
+  StagingRing stagingRing;
+  /** @brief Check if the per-frame upload budget still allows another upload */
+  bool withinUploadBudget(size_t bytes, float ms) const;
   int loadBlockCount = 0;
+  int inFlight = 0;                // jobs enqueued but not yet consumed
+  uint32_t frameID = 0;            // generation of the jobs confirmed this frame
+  size_t uploadBudgetBytes = 0;    // per-frame upload budget in async mode, 0 = unlimited
+  float uploadBudgetMs = 0.0f;     // per-frame upload budget in async mode, 0 = unlimited
+  uint64_t frameBytes = 0;         // bytes uploaded into the arena this frame
 
   // image export
-  /** @brief Save framebuffer to PNG file */
-  void saveFramePNG(const std::string& path, int w, int h);
+  /** @brief Start the PBO readback and the writers if export mode enabled */
+  bool setupExport();
   /** @brief Export current frame if export mode enabled */
   void exportFrame();
+  FrameExporter exporter;
+  std::filesystem::path exportDir;
+  ExportFormat exportFormat = EXPORT_PNG;
+  int exportWriters = 2;
 
   // performance check
   /** @brief Update benchmark statistics per frame */
   void updateBenchmarks();
   /** @brief Update window title with FPS info */
   void updateWindowTitle(float fps);
-  /** @brief Print benchmark results to stdout */
+  /** @brief Summarize the measured frames and print them to stdout */
   void printStats();
+  BenchStats bench;
   uint64_t vertexCount = 0;
   int visibleCount = 0;
   int limit = 0;
   int cacheMiss = 0;
-  int maxCacheMiss = -INT_MAX;
-  int minCacheMiss = INT_MAX;
-  int maxVisibleCount = -INT_MAX;
-  int minVisibleCount = INT_MAX;
-  double minFPS = 0.0;
-  double maxFPS = 0.0;
-  double avgFPS = 0.0;
+  int maxInFlight = 0;
+  int cancelledJobs = 0;
 
   glm::vec3 dir;
-  /** @brief Set orbital camera pose for test mode */
+  /** @brief Set the camera pose of this frame (replay or test orbit), record it if asked */
   void setCameraPose();
+  CameraPath cameraPath;      // replayed poses
+  CameraPath recordedPath;    // poses of this run
+  std::filesystem::path cameraRecordPath;
+  size_t cameraFrame = 0;     // next pose of cameraPath
+  bool isReplay = false;
 
   // Frustum culling
-  /** @brief Test if AABB intersects view frustum */
-  void aabbIntersectsFrustum(Block & block);
-  /** @brief Build frustum planes from projection matrix */
-  void buildFrustumPlanes();
-  std::array<Plane, 6> planes;
+  FrustumCuller culler;
+  CullOutput cullOut;     // this frame, by blockID
+  CullOutput futureCull;  // predicted camera, by blockID (prefetch)
+  int cullThreads = 1;
+  OcclusionCuller occlusion;
+  bool isOcclusion = false;
+  int occlusionSamples = 1;
+  int occludedCount = 0;  // blocks in the frustum hidden this frame
 
   // initialization parameters
   std::filesystem::path plyPath;
   std::filesystem::path outDir;
   std::filesystem::path shader_vert;
   std::filesystem::path shader_frag;
+  std::filesystem::path shader_occlusion_vert;
+  std::filesystem::path shader_occlusion_frag;
+  std::filesystem::path shader_compute;
+  std::filesystem::path shader_resolve_vert;
+  std::filesystem::path shader_resolve_frag;
+
+  // still camera: skip culling, refine progressively
+  /** @brief Count the frames view and proj stayed the same */
+  void updateStill();
+  /** @brief Still frames after which culling and sorting give the same result again */
+  int settleFrames() const;
+  /** @brief Draw what the frames before left out into the accumulated framebuffer */
+  void drawProgressive();
+  /** @brief Upload a progressive result into a spare region and draw it */
+  void uploadProgressive(Result& r);
+  /** @brief Copy the offscreen framebuffer into the window */
+  void presentOffscreen();
+  glm::mat4 lastView, lastProj;
+  bool viewDirty = true;       // forces the next frame to count as moved
+  int stillFrames = 0;         // frames in a row with the view and proj of the frame before
+  bool isProgressive = false;
+  bool accumulating = false;   // this frame draws on top of the last one instead of clearing
+  int progressiveBlocks = 32;
+  int progressiveNext = -1;    // next rank past limit to add, -1 until the still view is complete
+  int progressiveLOD = 0;      // next rank below limit whose points past lodCount are added (in-core)
+  int progressivePending = 0;  // progressive jobs in flight
+  std::vector<int> progressiveFree; // spare regions (out-of-core)
+  std::vector<int> progressiveUsed; // drawn from this frame, free again in the next one
+
+  // frame time budget
+  /** @brief Size the slot capacity to the free video memory and start the controller */
+  void setupBudget();
+  /** @brief Slots drawn per frame, the controller's share of num_slots */
+  int slotBudget() const;
+  BudgetController frameBudget;
+  float targetFrameMs = 0.0f;
+  float vramFraction = 0.5f;
+
+  // render backend
+  /** @brief Set up the compute backend, falls back to GL_POINTS without GL 4.3 */
+  bool setupBackend();
+  RenderBackend renderBackend = RENDER_POINTS;
+  ComputeRasterizer compute;
 
   // Data Manager
   DataManager dataManager;
+  PartitionConfig partitionConfig;
 
   // Bboxes of the loaded scene
   glm::vec3 bb_min;
@@ -205,21 +332,40 @@ private:
 
   // Parameters for benchmarks
   ProfilerCPU profilerCPU;
-  const int warmup = 60;
-  const int N = 600;
-  const float fixedDt = 1.0f / 60.0f;
+  ProfilerGPU profilerGPU;
+  std::string tracePath; // Chrome trace output, empty = no trace
+  int warmup = 60;
+  int N = 600;
+  float fixedDt = 1.0f / 60.0f;
   float angularSpeed = 0.0f; // glm::radians(10.0f); // this is 10.0 degrees/sec
   float distFactor = 0.0f;
 
+  // headless mode: hidden window, rendering into an offscreen framebuffer (progressive mode renders there, too)
+  /** @brief Size of the framebuffer rendered into, offscreen or the window's */
+  void framebufferSize(int& w, int& h) const;
+  /** @brief End a headless frame in place of the swap: flush, keep at most HEADLESS_FRAMES in flight */
+  void presentHeadless();
+  bool isHeadless = false;
+  GLuint offscreenFBO = 0;
+  GLuint offscreenColor = 0;  // renderbuffers of offscreenFBO
+  GLuint offscreenDepth = 0;
+  GLsync frameFences[HEADLESS_FRAMES] = {};
+  int frameFence = 0;         // fence of the oldest frame in flight
+
   // initializers
   bool glInitialized = false;
   bool cacheInitialized = false;
+  std::unordered_set<int> warmupPending; // cache warm-up blocks in flight
 
   // Modes Selection
   bool isTest;
   bool isOOC;
   bool isCache;
   bool isExport;
+  bool isAsync;
+  bool isRebuild;
+  bool isPersistent;
+  bool isLOD;
 
   // blocks / slots / cached blocks in subSlot
   std::vector<Block> blocks;
@@ -227,6 +373,7 @@ private:
   // std::vector<unsigned int> vao;
   // std::vector<unsigned int> vbo;
   SubslotsCache subSlots;
+  ResidencyTable residency; // blockID -> slot index or subslot handle
 
 };
 
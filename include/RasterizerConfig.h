@@ -0,0 +1,99 @@
+//=============================================================================
+//
+//   RasterizerConfig - Settings of one rasterizer run
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef RASTERIZERCONFIG_H
+#define RASTERIZERCONFIG_H
+
+#include <string>
+#include <filesystem>
+#include "Partitioner.h"
+#include "EvictionPolicy.h"
+#include "ComputeRasterizer.h"
+#include "FrameExporter.h"
+#include "BlockReader.h"
+
+constexpr int DEFAULT_WORKERS = 5; // out-of-core loader threads
+
+/**
+ * @brief Everything Rasterizer::init() needs, with the defaults of a plain run
+ */
+struct RasterizerConfig {
+  // files
+  std::filesystem::path plyPath = "../data/Church.ply";
+  std::filesystem::path outDir = "../data";
+  std::filesystem::path shader_vert = "../src/shader/shader.vert";
+  std::filesystem::path shader_frag = "../src/shader/shader.frag";
+  std::filesystem::path shader_occlusion_vert = "../src/shader/occlusion.vert";
+  std::filesystem::path shader_occlusion_frag = "../src/shader/occlusion.frag";
+  std::filesystem::path shader_compute = "../src/shader/compute_raster.comp";
+  std::filesystem::path shader_resolve_vert = "../src/shader/compute_resolve.vert";
+  std::filesystem::path shader_resolve_frag = "../src/shader/compute_resolve.frag";
+  std::string tracePath; // Chrome trace output, empty = no trace
+
+  // modes
+  bool isTest = false;
+  bool isOOC = false;
+  bool isCache = false;
+  bool isExport = false;
+  bool isHeadless = false;       // hidden window, offscreen framebuffer, implies isTest without a path
+  bool isAsync = false;
+  bool isRebuild = false;
+  bool isPersistent = false;
+  bool isLOD = false;
+  float lodDensity = 1.0f; // points per covered pixel
+  PartitionConfig partition;
+
+  // window and projection
+  unsigned int window_width = 800;
+  unsigned int window_height = 600;
+  float z_near = 1.0f;
+  float z_far = 100.0f;
+
+  // orbital camera of test mode
+  float rotateAngle = 30.0f;     // degrees per second
+  float distanceFactor = 0.05f;  // orbit radius relative to the bbox diagonal
+
+  // recorded camera paths (see CameraPath)
+  std::filesystem::path cameraPath;       // replay instead of orbit/input, empty = off
+  std::filesystem::path cameraRecordPath; // record the poses of this run, empty = off
+
+  // out-of-core capacity
+  float slotFactor = 0.30f;      // slots per non-empty block
+  float subslotRatio = 0.5f;     // subslots per slot (with isCache)
+  CachePolicy cachePolicy = CACHE_LRU; // replacement strategy of the subslots
+  int numWorkers = DEFAULT_WORKERS;
+  IOConfig io;                   // how the workers read the block store
+  float uploadBudgetMB = 0.0f;   // per frame, 0 = unlimited
+  float uploadBudgetMs = 0.0f;   // per frame, 0 = unlimited
+  bool isPrefetch = false;       // load predicted blocks into subslots (with isCache)
+  int prefetchFrames = 30;       // how far ahead the camera is predicted
+  float targetFrameMs = 0.0f;    // adapt slots and points to this frame time (BudgetController), 0 = off
+  float vramFraction = 0.5f;     // share of the free video memory the slots may take (with targetFrameMs)
+
+  // rendering
+  RenderBackend renderBackend = RENDER_POINTS;
+  bool isProgressive = false;    // refine still views in an accumulated framebuffer (points backend)
+  int progressiveBlocks = 32;    // blocks added to a still view per frame
+
+  // frame export (with isExport)
+  std::filesystem::path exportDir = "../outputs";
+  ExportFormat exportFormat = EXPORT_PNG;
+  int exportWriters = 2;         // encoder threads
+
+  // culling
+  int cullThreads = 1;           // threads for large block counts (FrustumCuller)
+  bool isOcclusion = false;      // hide blocks behind drawn points (OcclusionCuller)
+  int occlusionSamples = 1;      // samples a box needs to count as visible
+
+  // benchmark
+  int warmup = 60;               // frames before statistics are taken
+  int frames = 600;              // measured frames
+  float fixedDt = 1.0f / 60.0f;  // simulated time step of the camera
+};
+
+#endif // RASTERIZERCONFIG_H
@@ -0,0 +1,82 @@
+//=============================================================================
+//
+//   Residency - Where each block currently lives, indexed by blockID
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef RESIDENCY_H
+#define RESIDENCY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+typedef enum : uint8_t {
+  RESIDENT_NONE,    // on disk only
+  RESIDENT_SLOT,    // in a primary slot, loading or loaded
+  RESIDENT_SUBSLOT  // in the subslots cache
+} ResidencyState;
+
+/**
+ * @brief Residency of one block
+ */
+struct Residency {
+  ResidencyState state = RESIDENT_NONE;
+  int index = -1; // slot index or subslot handle
+};
+
+/**
+ * @brief Dense block -> slot/subslot table
+ *
+ * One entry per block, so lookups are a single array access regardless of
+ * how many slots there are. The primary slots and the subslots cache write
+ * their own entries; release() only clears an entry that still points at
+ * the given place, so the order in which a block is handed between slots
+ * and subslots does not matter.
+ */
+class ResidencyTable {
+public:
+  /** @brief One empty entry per block */
+  void init(size_t numBlocks) { table.assign(numBlocks, Residency()); }
+
+  /** @brief Forget all entries, keeps the size */
+  void reset() { std::fill(table.begin(), table.end(), Residency()); }
+
+  /** @brief Residency of a block, RESIDENT_NONE for ids out of range */
+  Residency get(int blockID) const {
+    return valid(blockID) ? table[blockID] : Residency();
+  }
+
+  /** @brief Slot index of a block, -1 if it is not in a slot */
+  int slot(int blockID) const { return indexIf(blockID, RESIDENT_SLOT); }
+
+  /** @brief Subslot handle of a block, -1 if it is not cached */
+  int subslot(int blockID) const { return indexIf(blockID, RESIDENT_SUBSLOT); }
+
+  /** @brief true if the block is in a slot or in the subslots cache */
+  bool isResident(int blockID) const { return valid(blockID) && table[blockID].state != RESIDENT_NONE; }
+
+  /** @brief Block now lives at the given place, ids < 0 (empty slots) are ignored */
+  void set(int blockID, ResidencyState state, int index) {
+    if (valid(blockID)) table[blockID] = { state, index };
+  }
+
+  /** @brief Block left the given place; no-op if it has moved on already */
+  void release(int blockID, ResidencyState state, int index) {
+    if (valid(blockID) && table[blockID].state == state && table[blockID].index == index) {
+      table[blockID] = Residency();
+    }
+  }
+
+private:
+  bool valid(int blockID) const { return blockID >= 0 && blockID < (int)table.size(); }
+  int indexIf(int blockID, ResidencyState state) const {
+    return (valid(blockID) && table[blockID].state == state) ? table[blockID].index : -1;
+  }
+
+  std::vector<Residency> table;
+};
+
+#endif // RESIDENCY_H
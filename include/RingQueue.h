@@ -0,0 +1,182 @@
+//=============================================================================
+//
+//   RingQueue - Bounded lock-free multi-producer multi-consumer queue
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef RINGQUEUE_H
+#define RINGQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+constexpr int RING_SPINS = 64; // failed polls before a consumer goes to sleep
+
+/**
+ * @brief Fixed-capacity queue where push and try_pop never take a lock
+ *
+ * Every cell carries a sequence number that tells producers and consumers
+ * whose turn it is; a thread claims a cell with one compare-exchange on the
+ * head or tail counter and publishes it by bumping the sequence. The mutex
+ * and condition variable are only touched when a consumer actually sleeps in
+ * pop(), so with results arriving faster than they are read nobody locks.
+ *
+ * Same interface as Queue. push() on a full queue yields until a cell is
+ * free, so a thread that also consumes must use try_push() instead; it
+ * would wait for itself.
+ */
+template <class T>
+class RingQueue {
+public:
+  /**
+   * @brief Allocate the cells, not thread-safe; drops anything queued
+   * @param minCapacity rounded up to a power of two
+   */
+  void init(size_t minCapacity) {
+    size_t cap = 2;
+    while (cap < minCapacity) cap <<= 1;
+    cells_.reset(new Cell[cap]);
+    for (size_t i = 0; i < cap; i++) cells_[i].seq.store(i, std::memory_order_relaxed);
+    mask_ = cap - 1;
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    stop_.store(false, std::memory_order_relaxed);
+  }
+
+  /** @brief Number of cells */
+  size_t capacity() const { return mask_ + 1; }
+
+  /**
+   * @brief Push an item and wake a sleeping consumer, if any
+   * @param v The value to push
+   */
+  void push(T v) {
+    while (!try_push(v)) std::this_thread::yield();
+    // orders the publish before the sleeper check, pairs with the re-check in pop()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> lk(m_);
+      cv_.notify_one();
+    }
+  }
+
+  /**
+   * @brief Push without waiting for a free cell
+   * @return false if the queue is full, v is left untouched
+   */
+  bool try_push(T& v) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& c = cells_[pos & mask_];
+      size_t seq = c.seq.load(std::memory_order_acquire);
+      std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          c.value = std::move(v);
+          c.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false; // a full lap ahead of the consumers
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * @brief Try to pop without blocking.
+   * @param out Reference to store the popped value
+   * @return true if item was popped, false if queue was empty
+   */
+  bool try_pop(T& out) {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& c = cells_[pos & mask_];
+      size_t seq = c.seq.load(std::memory_order_acquire);
+      std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          out = std::move(c.value);
+          c.seq.store(pos + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false; // the producer of this cell has not published yet
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * @brief Pop an item, blocking if empty
+   *
+   * Spins for a few polls first, then sleeps until a push or stop().
+   *
+   * @param out Reference to store the popped value
+   * @return true if an item was successfully popped, false if stopped
+   */
+  bool pop(T& out) {
+    for (int i = 0; i < RING_SPINS; i++) {
+      if (try_pop(out)) return true;
+      std::this_thread::yield();
+    }
+    for (;;) {
+      if (try_pop(out)) return true;
+      if (stop_.load(std::memory_order_acquire)) return try_pop(out);
+
+      std::unique_lock<std::mutex> lk(m_);
+      sleepers_.fetch_add(1, std::memory_order_seq_cst);
+      // re-check after announcing, a push in between would not have notified
+      if (!empty() || stop_.load(std::memory_order_acquire)) {
+        sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+        continue;
+      }
+      cv_.wait(lk);
+      sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+  }
+
+  /**
+   * @brief Signal all threads to stop waiting and exit.
+   *
+   * Subsequent pop() calls will return false once the queue is empty.
+   */
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lk(m_);
+      stop_.store(true, std::memory_order_release);
+    }
+    cv_.notify_all();
+  }
+
+private:
+  /** @brief true if the next cell to pop is not published */
+  bool empty() const {
+    size_t pos = head_.load(std::memory_order_seq_cst);
+    return cells_[pos & mask_].seq.load(std::memory_order_seq_cst) != pos + 1;
+  }
+
+  struct Cell {
+    std::atomic<size_t> seq;
+    T value;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_ = 0;
+  alignas(64) std::atomic<size_t> tail_{0}; // next cell to push, producers only
+  alignas(64) std::atomic<size_t> head_{0}; // next cell to pop, consumers only
+  alignas(64) std::atomic<int> sleepers_{0};
+  std::atomic<bool> stop_{false};
+  std::mutex m_;
+  std::condition_variable cv_;
+};
+
+#endif // RINGQUEUE_H
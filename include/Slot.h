@@ -20,9 +20,10 @@ typedef enum {
  */
 struct Slot {
   int blockID = -1;
-  int count = 0;
+  int count = 0;     // points uploaded, a progressive prefix of the block
+  int requested = 0; // points uploaded or in flight (>= count)
   Status status = EMPTY;
-  unsigned int vbo = 0, vao = 0;
+  int region = -1; // region of the slot arena holding the points
   // std::vector<Point> points;
 };
 #endif // SLOT_H
@@ -0,0 +1,79 @@
+//=============================================================================
+//
+//   SlotArena - One shared vertex buffer for all slots and subslots
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef SLOTARENA_H
+#define SLOTARENA_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+class ComputeRasterizer;
+
+/**
+ * @brief Fixed-size regions carved out of one VBO with one VAO
+ *
+ * Every slot and subslot owns one region, so handing a block between the
+ * slots and the subslots cache only moves the region index. The quantization
+ * frame of each region lives in a buffer texture; the vertex shader finds
+ * its region from gl_VertexID, which lets one multi-draw cover blocks with
+ * different frames.
+ */
+class SlotArena {
+public:
+  /** @brief Allocate the arena, the region frames and the draw buffers */
+  bool init(int numRegions_, int pointsPerRegion_, size_t pointSize);
+
+  /** @brief Delete all GL objects */
+  void destroy();
+
+  /** @brief Take a free region, -1 if none is left */
+  int acquire();
+
+  /** @brief Give a region back */
+  void release(int region);
+
+  /** @brief Store the quantization frame of the block held by a region */
+  void setFrame(int region, const glm::vec3& bb_min, const glm::vec3& bb_max);
+
+  /** @brief Queue a draw of count points of a region, starting at point start */
+  void addDraw(int region, int count, int start = 0);
+
+  /** @brief Issue all queued draws in one call and clear the list */
+  void flushDraws();
+
+  /** @brief Send the draws to the compute backend instead of GL_POINTS, nullptr = off */
+  void setCompute(ComputeRasterizer* compute_) { compute = compute_; }
+
+  /** @brief First vertex of a region */
+  GLint first(int region) const { return (GLint)region * pointsPerRegion; }
+
+  /** @brief Byte offset of a region in the arena VBO */
+  GLintptr byteOffset(int region) const { return (GLintptr)first(region) * (GLintptr)stride; }
+
+  GLuint vbo() const { return arenaVBO; }
+  GLuint frames() const { return frameTex; }
+  int regionPoints() const { return pointsPerRegion; }
+
+private:
+  GLuint arenaVAO = 0, arenaVBO = 0;
+  GLuint frameBuf = 0, frameTex = 0; // 2 texels per region: bb_min, extent
+  GLuint indirectBuf = 0;
+  int numRegions = 0;
+  int pointsPerRegion = 0;
+  size_t stride = 0;
+  std::vector<int> freeRegions;
+  ComputeRasterizer* compute = nullptr;
+
+  // draw list of the current batch
+  std::vector<GLint> drawFirst;
+  std::vector<GLsizei> drawCount;
+};
+
+#endif // SLOTARENA_H
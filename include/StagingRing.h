@@ -0,0 +1,65 @@
+//=============================================================================
+//
+//   StagingRing - Persistently mapped, fence-guarded upload staging buffer
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#ifndef STAGINGRING_H
+#define STAGINGRING_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+constexpr int STAGING_REGIONS = 32; // upper bound of jobs in flight with the staging path
+
+/**
+ * @brief Ring of fixed-size staging regions in one persistently mapped buffer
+ *
+ * Requires glBufferStorage (GL 4.4 / ARB_buffer_storage). The main thread
+ * acquires a region per job, a worker writes the block straight into the
+ * mapped memory, and the main thread copies it into the slot VBO on the GPU
+ * with glCopyBufferSubData. A fence after the copy guards the region until
+ * the GPU is done reading it.
+ */
+class StagingRing {
+public:
+  /** @brief Create and map the staging buffer, false if buffer storage is unavailable */
+  bool init(size_t regionBytes_, int numRegions);
+
+  /** @brief Unmap and delete the buffer */
+  void destroy();
+
+  /** @brief Get a free region index without blocking, -1 if all are in use */
+  int acquire();
+
+  /** @brief Return a region whose data was copied; reusable once the GPU passed the fence */
+  void release(int idx);
+
+  /** @brief Return a region that was never read by the GPU */
+  void discard(int idx);
+
+  /** @brief Mapped pointer of a region */
+  void* region(int idx) const { return mapped + (size_t)idx * regionBytes; }
+
+  /** @brief Byte offset of a region in the staging buffer */
+  GLintptr offset(int idx) const { return (GLintptr)((size_t)idx * regionBytes); }
+
+  /** @brief Staging buffer name */
+  GLuint buffer() const { return buf; }
+
+  /** @brief true if init() succeeded */
+  bool ready() const { return mapped != nullptr; }
+
+private:
+  GLuint buf = 0;
+  unsigned char* mapped = nullptr;
+  size_t regionBytes = 0;
+  std::vector<int> freeRegions;
+  std::vector<int> pending;       // released, waiting for their fence
+  std::vector<GLsync> fences;     // per region
+};
+
+#endif // STAGINGRING_H
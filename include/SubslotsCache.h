@@ -1,6 +1,6 @@
 //=============================================================================
 //
-//   SubslotsCache - LRU cache for out-of-core block management
+//   SubslotsCache - Cache of evicted slots for out-of-core block management
 //
 //   Copyright (C) 2026 Hyovin Kwak
 //
@@ -9,27 +9,48 @@
 #ifndef SUBSLOTSCACHE_H
 #define SUBSLOTSCACHE_H
 
-#include <list>
-#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
 #include "Slot.h"
+#include "EvictionPolicy.h"
+#include "Residency.h"
 
 /**
- * @brief LRU cache for out-of-core block management
+ * @brief Hit/miss/eviction counters of the cache
+ */
+struct CacheStats {
+    uint64_t hits = 0;      // extract() found the block
+    uint64_t misses = 0;    // extract() did not
+    uint64_t inserts = 0;
+    uint64_t evictions = 0;
+};
+
+/**
+ * @brief Cache for out-of-core block management
+ *
+ * Stores blocks that have been evicted from the primary slots but may be
+ * needed again soon. Which block goes when the cache is full is up to the
+ * EvictionPolicy (LRU, 2Q or cost-aware).
  *
- * Implements a Least Recently Used cache to store blocks that have been
- * evicted from the primary slots but may be needed again soon.
+ * Cached slots live in a fixed array; the handle of a block (its index in
+ * that array) is kept in the shared ResidencyTable, next to the primary slots.
  */
 class SubslotsCache {
 public:
     /**
      * @brief Initialize cache with given capacity
      * @param size Maximum number of slots to cache
+     * @param residency block table the cache keeps its entries in, owned by the caller
+     * @param policy replacement strategy
+     * @param scores per block id keep scores for CACHE_COST, owned by the caller
      * @return true if initialization succeeds
      */
-    bool init(int size);
+    bool init(int size, ResidencyTable* residency, CachePolicy policy = CACHE_LRU, const std::vector<float>* scores = nullptr);
 
     /**
-     * @brief Mark block as recently used (move to MRU position)
+     * @brief Mark block as recently used
      * @param blockID ID of the block to touch
      * @return true if block was found and touched
      */
@@ -44,10 +65,29 @@ public:
     bool put(Slot s, Slot* evicted = nullptr);
 
     /**
-     * @brief Evict the least recently used slot
-     * @return blockID of the evicted slot
+     * @brief Evict the slot chosen by the policy
+     * @param evicted Optional pointer to receive the evicted slot (and its region)
+     * @return blockID of the evicted slot, -1 if the cache is empty
      */
-    int evictSubslot();
+    int evictSubslot(Slot* evicted = nullptr);
+
+    /**
+     * @brief Check if a block is cached, without touching it
+     */
+    bool contains(int blockID) const { return residency && residency->subslot(blockID) >= 0; }
+
+    /**
+     * @brief Cached slot of a block without touching it, nullptr if not cached
+     */
+    const Slot* peek(int blockID) const {
+        int handle = residency ? residency->subslot(blockID) : -1;
+        return handle >= 0 ? &entries[handle] : nullptr;
+    }
+
+    /**
+     * @brief Number of cached slots
+     */
+    size_t size() const { return count; }
 
     /**
      * @brief Extract a slot by blockID, removing it from cache
@@ -58,14 +98,27 @@ public:
     bool extract(int blockID, Slot& out);
 
     /**
-     * @brief Clear cache, deleting all VAO/VBO resources
+     * @brief Clear cache (the slot arena owns the buffer memory)
      */
     void clear();
 
+    /** @brief Counters since init() */
+    const CacheStats& stats() const { return counters; }
+
 private:
-    size_t capacity;
-    std::list<Slot> slots;
-    std::unordered_map<int, std::list<Slot>::iterator> where;
+    /** @brief Remove the policy's victim, optionally handing it out */
+    int evict(Slot* evicted);
+
+    /** @brief Move the slot out of a handle and free it */
+    void take(int handle, Slot* out);
+
+    size_t capacity = 0;
+    size_t count = 0;
+    std::vector<Slot> entries;   // capacity handles
+    std::vector<int> freeHandles;
+    ResidencyTable* residency = nullptr;
+    std::unique_ptr<EvictionPolicy> policy;
+    CacheStats counters;
 };
 
 #endif // SUBSLOTSCACHE_H
@@ -0,0 +1,361 @@
+//=============================================================================
+//
+//   Benchmark - Runs a matrix of rasterizer configurations
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "Benchmark.h"
+#include "Rasterizer.h"
+#include <iostream>
+#include <sstream>
+#include <memory>
+
+namespace {
+
+/** @brief Split a comma separated list, blanks are dropped */
+std::vector<std::string> splitList(const std::string& s) {
+  std::vector<std::string> out;
+  std::stringstream ss(s);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    size_t b = item.find_first_not_of(" \t");
+    size_t e = item.find_last_not_of(" \t\r");
+    if (b != std::string::npos) out.push_back(item.substr(b, e - b + 1));
+  }
+  return out;
+}
+
+/** @brief Quote a string for JSON */
+std::string jsonString(const std::string& s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') out += '\\';
+    out += c;
+  }
+  return out + "\"";
+}
+
+/** @brief Short name of the rendering mode */
+std::string modeName(const RasterizerConfig& c) {
+  if (!c.isOOC) return c.isOcclusion ? "incore+occlusion" : "incore";
+  std::string m = "ooc";
+  if (c.isCache) m += "+cache";
+  if (c.isAsync) m += "+async";
+  if (c.isPersistent) m += "+persistent";
+  if (c.isLOD) m += "+lod";
+  if (c.isPrefetch) m += "+prefetch";
+  if (c.isOcclusion) m += "+occlusion";
+  return m;
+}
+
+} // namespace
+
+/**
+ * @brief True if key names a dimension
+ */
+bool BenchmarkMatrix::isKey(const std::string& key) {
+  return key == "slot-factor" || key == "subslot-ratio" || key == "workers" || key == "grid"
+      || key == "max-block-points" || key == "rotate" || key == "resolution" || key == "camera-path" || key == "cache-policy" || key == "backend";
+}
+
+/**
+ * @brief Set a dimension from a comma separated list
+ * @param key dimension name, see isKey()
+ * @param values e.g. "0.2,0.3" or "800x600,1280x720" for the resolution
+ */
+bool BenchmarkMatrix::set(const std::string& key, const std::string& values) {
+  std::vector<std::string> items = splitList(values);
+  if (items.empty()) {
+    std::cerr << "Error: No values for " << key << "." << std::endl;
+    return false;
+  }
+  try {
+    if (key == "slot-factor") {
+      slotFactor.clear();
+      for (auto& v : items) slotFactor.push_back(std::stof(v));
+    } else if (key == "subslot-ratio") {
+      subslotRatio.clear();
+      for (auto& v : items) subslotRatio.push_back(std::stof(v));
+    } else if (key == "workers") {
+      workers.clear();
+      for (auto& v : items) workers.push_back(std::stoi(v));
+    } else if (key == "grid") {
+      grid.clear();
+      for (auto& v : items) grid.push_back(std::stoi(v));
+    } else if (key == "max-block-points") {
+      maxBlockPoints.clear();
+      for (auto& v : items) maxBlockPoints.push_back(std::stoull(v));
+    } else if (key == "rotate") {
+      rotateAngle.clear();
+      for (auto& v : items) rotateAngle.push_back(std::stof(v));
+    } else if (key == "resolution") {
+      resolution.clear();
+      for (auto& v : items) {
+        size_t x = v.find('x');
+        if (x == std::string::npos) {
+          std::cerr << "Error: Resolution must be WxH, got " << v << "." << std::endl;
+          return false;
+        }
+        resolution.emplace_back((unsigned int)std::stoul(v.substr(0, x)), (unsigned int)std::stoul(v.substr(x + 1)));
+      }
+    } else if (key == "cache-policy") {
+      cachePolicy.clear();
+      for (auto& v : items) {
+        CachePolicy p;
+        if (!parseCachePolicy(v, p)) {
+          std::cerr << "Error: Unknown cache policy " << v << " (lru|2q|cost)." << std::endl;
+          return false;
+        }
+        cachePolicy.push_back(p);
+      }
+    } else if (key == "backend") {
+      backend.clear();
+      for (auto& v : items) {
+        RenderBackend b;
+        if (!parseRenderBackend(v, b)) {
+          std::cerr << "Error: Unknown render backend " << v << " (points|compute)." << std::endl;
+          return false;
+        }
+        backend.push_back(b);
+      }
+    } else if (key == "camera-path") {
+      cameraPath = items;
+    } else {
+      std::cerr << "Error: Unknown benchmark dimension: " << key << std::endl;
+      return false;
+    }
+  } catch (const std::exception&) {
+    std::cerr << "Error: Could not parse values of " << key << ": " << values << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Set dimensions from a file of "key = v1, v2" lines
+ */
+bool BenchmarkMatrix::load(const std::filesystem::path& path) {
+  std::ifstream is(path);
+  if (!is.is_open()) {
+    std::cerr << "Error: Could not open benchmark config: " << path << std::endl;
+    return false;
+  }
+  std::string line;
+  int lineNo = 0;
+  while (std::getline(is, line)) {
+    lineNo++;
+    line = line.substr(0, line.find('#'));
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+    size_t eq = line.find('=');
+    if (eq == std::string::npos) {
+      std::cerr << "Error: " << path << ":" << lineNo << ": expected key = values" << std::endl;
+      return false;
+    }
+    std::vector<std::string> key = splitList(line.substr(0, eq));
+    if (key.size() != 1 || !set(key[0], line.substr(eq + 1))) {
+      std::cerr << "Error: " << path << ":" << lineNo << ": invalid line" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Number of combinations
+ */
+size_t BenchmarkMatrix::size() const {
+  size_t n = 1;
+  n *= std::max<size_t>(slotFactor.size(), 1);
+  n *= std::max<size_t>(subslotRatio.size(), 1);
+  n *= std::max<size_t>(workers.size(), 1);
+  n *= std::max<size_t>(grid.size(), 1);
+  n *= std::max<size_t>(maxBlockPoints.size(), 1);
+  n *= std::max<size_t>(rotateAngle.size(), 1);
+  n *= std::max<size_t>(resolution.size(), 1);
+  n *= std::max<size_t>(cameraPath.size(), 1);
+  n *= std::max<size_t>(cachePolicy.size(), 1);
+  n *= std::max<size_t>(backend.size(), 1);
+  return n;
+}
+
+/**
+ * @brief Configuration of combination i
+ *
+ * The camera path varies fastest, then resolution, backend, rotation,
+ * partitioning, workers, cache policy, subslot ratio; the slot factor
+ * varies slowest. The runs CSV and JSONL rows come in this order.
+ */
+RasterizerConfig BenchmarkMatrix::at(const RasterizerConfig& base, size_t i) const {
+  RasterizerConfig c = base;
+  // mixed radix digits of i, one per dimension
+  auto pick = [&i](const auto& values, auto& field) {
+    if (values.empty()) return;
+    field = values[i % values.size()];
+    i /= values.size();
+  };
+  if (!cameraPath.empty()) {
+    const std::string& p = cameraPath[i % cameraPath.size()];
+    c.cameraPath = (p == "orbit") ? std::filesystem::path() : std::filesystem::path(p);
+    i /= cameraPath.size();
+  }
+  if (!resolution.empty()) {
+    const auto& r = resolution[i % resolution.size()];
+    c.window_width = r.first;
+    c.window_height = r.second;
+    i /= resolution.size();
+  }
+  pick(backend, c.renderBackend);
+  pick(rotateAngle, c.rotateAngle);
+  pick(maxBlockPoints, c.partition.maxBlockPoints);
+  pick(grid, c.partition.grid);
+  pick(workers, c.numWorkers);
+  pick(cachePolicy, c.cachePolicy);
+  pick(subslotRatio, c.subslotRatio);
+  pick(slotFactor, c.slotFactor);
+  return c;
+}
+
+/**
+ * @brief Run the matrix and write the results
+ * @param base settings shared by all runs
+ * @param prefix output path prefix
+ * @param runIndex only run this combination (appending to the outputs), all if < 0
+ */
+bool Benchmark::run(const RasterizerConfig& base, const BenchmarkMatrix& matrix, const std::string& prefix, int runIndex) {
+  size_t n = matrix.size();
+  if (runIndex >= (int)n) {
+    std::cerr << "Error: Benchmark run " << runIndex << " out of range, the matrix has " << n << " runs." << std::endl;
+    return false;
+  }
+  if (!open(prefix, runIndex >= 0)) return false;
+
+  size_t first = runIndex >= 0 ? (size_t)runIndex : 0;
+  size_t last = runIndex >= 0 ? first + 1 : n;
+  bool allOk = true;
+  for (size_t i = first; i < last; ++i) {
+    RasterizerConfig config = matrix.at(base, i);
+    std::cout << "==== Benchmark run " << i + 1 << " / " << n << " ====" << std::endl;
+
+    // one rasterizer (window, context, workers) per run
+    BenchStats stats;
+    bool ok = false;
+    {
+      auto rasterizer = std::make_unique<Rasterizer>();
+      ok = rasterizer->init(config);
+      if (ok) {
+        rasterizer->render();
+        stats = rasterizer->getBenchStats();
+      } else {
+        std::cerr << "Error: Benchmark run " << i << " failed to initialize." << std::endl;
+      }
+    }
+    write(i, config, ok, stats);
+    allOk = allOk && ok;
+  }
+  std::cout << "Benchmark results written to " << prefix << "_runs.csv, "
+            << prefix << "_frames.csv and " << prefix << ".jsonl" << std::endl;
+  return allOk;
+}
+
+/**
+ * @brief Open the output files, write headers into new or truncated ones
+ */
+bool Benchmark::open(const std::string& prefix, bool append) {
+  auto openOne = [append](std::ofstream& os, const std::string& path, const char* header) {
+    bool fresh = !append || !std::filesystem::exists(path) || std::filesystem::file_size(path) == 0;
+    os.open(path, append ? std::ios::app : std::ios::trunc);
+    if (!os.is_open()) {
+      std::cerr << "Error: Could not open benchmark output: " << path << std::endl;
+      return false;
+    }
+    if (fresh && header) os << header << "\n";
+    return true;
+  };
+  return openOne(runsCSV, prefix + "_runs.csv",
+                 "run,status,ply,mode,backend,partition,grid,max_block_points,slot_factor,subslot_ratio,cache_policy,workers,"
+                 "camera,rotate,width,height,warmup,frames,blocks,slots,subslots,avg_fps,min_fps,max_fps,"
+                 "p50_ms,p95_ms,p99_ms,max_cache_miss,max_visible,bytes_streamed,max_in_flight,cancelled_jobs,prefetch_loads,prefetch_hits,cache_hits,cache_misses,cache_inserts,cache_evictions,max_occluded")
+      && openOne(framesCSV, prefix + "_frames.csv", "run,frame,ms,visible,cache_miss,bytes_streamed,occluded")
+      && openOne(json, prefix + ".jsonl", nullptr);
+}
+
+/**
+ * @brief Append the results of one run to all outputs
+ */
+void Benchmark::write(size_t run, const RasterizerConfig& c, bool ok, const BenchStats& s) {
+  const char* partition = c.partition.mode == PARTITION_KD ? "kd" : "grid";
+
+  runsCSV << run << "," << (ok ? "ok" : "failed") << "," << c.plyPath.filename().string() << ","
+          << modeName(c) << "," << renderBackendName(c.renderBackend) << "," << partition << "," << c.partition.grid << "," << c.partition.maxBlockPoints << ","
+          << c.slotFactor << "," << c.subslotRatio << "," << cachePolicyName(c.cachePolicy) << "," << c.numWorkers << ","
+          << (c.cameraPath.empty() ? std::string("orbit") : c.cameraPath.filename().string()) << "," << c.rotateAngle << ","
+          << c.window_width << "," << c.window_height << "," << c.warmup << "," << s.frames.size() << ","
+          << s.numBlocks << "," << s.numSlots << "," << s.numSubSlots << ","
+          << s.avgFPS << "," << s.minFPS << "," << s.maxFPS << ","
+          << s.p50_ms << "," << s.p95_ms << "," << s.p99_ms << ","
+          << s.maxCacheMiss << "," << s.maxVisibleCount << "," << s.bytesStreamed << ","
+          << s.maxInFlight << "," << s.cancelledJobs << "," << s.prefetchLoads << "," << s.prefetchHits << ","
+          << s.cacheHits << "," << s.cacheMisses << "," << s.cacheInserts << "," << s.cacheEvictions << "," << s.maxOccluded << "\n";
+  runsCSV.flush();
+
+  for (size_t f = 0; f < s.frames.size(); ++f) {
+    const FrameRecord& r = s.frames[f];
+    framesCSV << run << "," << f << "," << r.ms << "," << r.visibleCount << ","
+              << r.cacheMiss << "," << r.bytesStreamed << "," << r.occluded << "\n";
+  }
+  framesCSV.flush();
+
+  json << "{\"run\":" << run << ",\"status\":" << jsonString(ok ? "ok" : "failed")
+       << ",\"config\":{\"ply\":" << jsonString(c.plyPath.string())
+       << ",\"mode\":" << jsonString(modeName(c))
+       << ",\"backend\":" << jsonString(renderBackendName(c.renderBackend))
+       << ",\"partition\":" << jsonString(partition)
+       << ",\"grid\":" << c.partition.grid
+       << ",\"max_block_points\":" << c.partition.maxBlockPoints
+       << ",\"slot_factor\":" << c.slotFactor
+       << ",\"subslot_ratio\":" << c.subslotRatio
+       << ",\"cache_policy\":" << jsonString(cachePolicyName(c.cachePolicy))
+       << ",\"workers\":" << c.numWorkers
+       << ",\"camera\":" << jsonString(c.cameraPath.empty() ? "orbit" : c.cameraPath.string())
+       << ",\"rotate\":" << c.rotateAngle
+       << ",\"width\":" << c.window_width
+       << ",\"height\":" << c.window_height
+       << ",\"warmup\":" << c.warmup
+       << ",\"frames\":" << c.frames << "}"
+       << ",\"summary\":{\"blocks\":" << s.numBlocks
+       << ",\"slots\":" << s.numSlots
+       << ",\"subslots\":" << s.numSubSlots
+       << ",\"avg_fps\":" << s.avgFPS
+       << ",\"min_fps\":" << s.minFPS
+       << ",\"max_fps\":" << s.maxFPS
+       << ",\"p50_ms\":" << s.p50_ms
+       << ",\"p95_ms\":" << s.p95_ms
+       << ",\"p99_ms\":" << s.p99_ms
+       << ",\"max_cache_miss\":" << s.maxCacheMiss
+       << ",\"max_visible\":" << s.maxVisibleCount
+       << ",\"bytes_streamed\":" << s.bytesStreamed
+       << ",\"max_in_flight\":" << s.maxInFlight
+       << ",\"cancelled_jobs\":" << s.cancelledJobs
+       << ",\"prefetch_loads\":" << s.prefetchLoads
+       << ",\"prefetch_hits\":" << s.prefetchHits
+       << ",\"cache_hits\":" << s.cacheHits
+       << ",\"cache_misses\":" << s.cacheMisses
+       << ",\"cache_inserts\":" << s.cacheInserts
+       << ",\"cache_evictions\":" << s.cacheEvictions
+       << ",\"max_occluded\":" << s.maxOccluded << "}"
+       << ",\"frames\":{";
+  auto array = [&](const char* name, auto get, bool last) {
+    json << "\"" << name << "\":[";
+    for (size_t f = 0; f < s.frames.size(); ++f) json << (f ? "," : "") << get(s.frames[f]);
+    json << "]" << (last ? "" : ",");
+  };
+  array("ms", [](const FrameRecord& r) { return r.ms; }, false);
+  array("visible", [](const FrameRecord& r) { return r.visibleCount; }, false);
+  array("cache_miss", [](const FrameRecord& r) { return r.cacheMiss; }, false);
+  array("bytes_streamed", [](const FrameRecord& r) { return r.bytesStreamed; }, false);
+  array("occluded", [](const FrameRecord& r) { return r.occluded; }, true);
+  json << "}}\n";
+  json.flush();
+}
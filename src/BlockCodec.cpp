@@ -0,0 +1,109 @@
+//=============================================================================
+//
+//   BlockCodec - Chunked compression of the points in the block store
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "BlockCodec.h"
+#include <algorithm>
+#include <iostream>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+/**
+ * @brief Name of a compression, as on the command line
+ */
+const char* compressionName(Compression compression) {
+  return compression == COMPRESSION_ZSTD ? "zstd" : "none";
+}
+
+/**
+ * @brief Parse none|zstd
+ */
+bool parseCompression(const std::string& name, Compression& compression) {
+  if (name == "none") { compression = COMPRESSION_NONE; return true; }
+  if (name == "zstd") { compression = COMPRESSION_ZSTD; return true; }
+  return false;
+}
+
+/**
+ * @brief true if this build can read and write the compression
+ */
+bool compressionAvailable(Compression compression) {
+#ifdef HAVE_ZSTD
+  (void)compression;
+  return true;
+#else
+  return compression == COMPRESSION_NONE;
+#endif
+}
+
+/**
+ * @brief Compress n <= CHUNK_POINTS points and append them to out
+ */
+bool encodeChunk(Compression compression, const PointQ* points, size_t n,
+                 std::vector<unsigned char>& planes, std::vector<unsigned char>& out) {
+  // byte j of point i goes to planes[j * n + i]
+  planes.resize(n * sizeof(PointQ));
+  const unsigned char* src = reinterpret_cast<const unsigned char*>(points);
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = 0; j < sizeof(PointQ); j++) planes[j * n + i] = src[i * sizeof(PointQ) + j];
+  }
+
+#ifdef HAVE_ZSTD
+  if (compression == COMPRESSION_ZSTD) {
+    size_t at = out.size();
+    out.resize(at + ZSTD_compressBound(planes.size()));
+    size_t bytes = ZSTD_compress(out.data() + at, out.size() - at, planes.data(), planes.size(), ZSTD_LEVEL);
+    if (ZSTD_isError(bytes)) {
+      std::cerr << "Error: zstd: " << ZSTD_getErrorName(bytes) << std::endl;
+      out.resize(at);
+      return false;
+    }
+    out.resize(at + bytes);
+    return true;
+  }
+#else
+  (void)out;
+#endif
+  std::cerr << "Error: Compression " << compressionName(compression) << " is not available in this build." << std::endl;
+  return false;
+}
+
+/**
+ * @brief Decode the points [first, first + count) of a compressed block
+ */
+bool decodeRange(Compression compression, const unsigned char* data, const uint32_t* chunks, size_t blockCount,
+                 size_t first, size_t count, PointQ* dst, std::vector<unsigned char>& scratch) {
+  if (count == 0) return true;
+  scratch.resize(CHUNK_POINTS * sizeof(PointQ));
+  unsigned char* out = reinterpret_cast<unsigned char*>(dst);
+  size_t end = first + count;
+  size_t origin = chunks[first / CHUNK_POINTS]; // where data starts in the block
+
+  for (size_t c = first / CHUNK_POINTS; c * CHUNK_POINTS < end; c++) {
+    size_t base = c * CHUNK_POINTS;
+    size_t n = std::min(CHUNK_POINTS, blockCount - base);
+    size_t bytes = n * sizeof(PointQ);
+#ifdef HAVE_ZSTD
+    if (compression != COMPRESSION_ZSTD) return false;
+    size_t got = ZSTD_decompress(scratch.data(), bytes, data + (chunks[c] - origin), chunks[c + 1] - chunks[c]);
+    if (ZSTD_isError(got) || got != bytes) return false;
+#else
+    (void)compression; (void)data; (void)origin; (void)bytes;
+    return false;
+#endif
+    // gather the bytes of the points in range back from the planes
+    size_t lo = std::max(first, base) - base;
+    size_t hi = std::min(end, base + n) - base;
+    for (size_t i = lo; i < hi; i++) {
+      unsigned char* p = out + (base + i - first) * sizeof(PointQ);
+      for (size_t j = 0; j < sizeof(PointQ); j++) p[j] = scratch[j * n + i];
+    }
+  }
+  return true;
+}
@@ -0,0 +1,221 @@
+//=============================================================================
+//
+//   BlockReader - Batched reads of the packed block file (pread, io_uring)
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "BlockReader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+/**
+ * @brief Name of an I/O backend, as on the command line
+ */
+const char* ioBackendName(IOBackend backend) {
+  switch (backend) {
+    case IO_PREAD: return "pread";
+    case IO_URING: return "uring";
+    default: return "mmap";
+  }
+}
+
+/**
+ * @brief Parse mmap|pread|uring
+ */
+bool parseIOBackend(const std::string& name, IOBackend& backend) {
+  if (name == "mmap") { backend = IO_MMAP; return true; }
+  if (name == "pread") { backend = IO_PREAD; return true; }
+  if (name == "uring") { backend = IO_URING; return true; }
+  return false;
+}
+
+/**
+ * @brief true if this build has the backend
+ */
+bool ioBackendAvailable(IOBackend backend) {
+#ifdef HAVE_LIBURING
+  (void)backend;
+  return true;
+#else
+  return backend != IO_URING;
+#endif
+}
+
+/**
+ * @brief open() with O_DIRECT if asked and possible
+ *
+ * Some file systems (tmpfs, some network mounts) refuse O_DIRECT; the
+ * reads then go through the page cache as before.
+ */
+int BlockReader::openFile(const std::filesystem::path& path, bool wantDirect) {
+  direct = false;
+  if (wantDirect) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_DIRECT);
+    if (fd >= 0) {
+      direct = true;
+      return fd;
+    }
+    std::cerr << "Warning: O_DIRECT refused for " << path << " (" << std::strerror(errno) << "), using buffered reads." << std::endl;
+  }
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) std::cerr << "Error: Could not open block store: " << path << std::endl;
+  return fd;
+}
+
+/**
+ * @brief pread() until need bytes or the end of the file
+ * @param done bytes of the request already read
+ */
+bool BlockReader::readFully(int fd, ReadRequest& req, size_t done) const {
+  unsigned char* dst = static_cast<unsigned char*>(req.dst);
+  while (done < req.bytes) {
+    ssize_t got = ::pread(fd, dst + done, req.bytes - done, (off_t)(req.offset + done));
+    if (got < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    if (got == 0) break; // end of file, the rest was alignment padding
+    done += (size_t)got;
+    // O_DIRECT continues at aligned offsets only
+    if (direct && done % IO_ALIGN != 0) break;
+  }
+  return done >= req.need;
+}
+
+PreadReader::~PreadReader() {
+  if (fd >= 0) ::close(fd);
+}
+
+/**
+ * @brief Open the file
+ */
+bool PreadReader::open(const std::filesystem::path& path, bool wantDirect, int) {
+  if (fd >= 0) ::close(fd);
+  fd = openFile(path, wantDirect);
+  return fd >= 0;
+}
+
+/**
+ * @brief One pread() per request, in order
+ */
+void PreadReader::read(std::vector<ReadRequest>& requests) {
+  for (ReadRequest& req : requests) req.ok = readFully(fd, req, 0);
+}
+
+#ifdef HAVE_LIBURING
+/**
+ * @brief All reads of a batch in one io_uring submission
+ *
+ * The device sees up to depth reads per worker at once instead of one, so
+ * a few workers keep an NVMe queue busy. Short reads are finished with
+ * pread().
+ */
+class UringReader : public BlockReader {
+public:
+  ~UringReader() override {
+    if (ready) io_uring_queue_exit(&ring);
+    if (fd >= 0) ::close(fd);
+  }
+
+  bool open(const std::filesystem::path& path, bool wantDirect, int depth) override {
+    fd = openFile(path, wantDirect);
+    if (fd < 0) return false;
+    int err = io_uring_queue_init((unsigned)std::max(1, depth), &ring, 0);
+    if (err < 0) {
+      std::cerr << "Error: io_uring_queue_init: " << std::strerror(-err) << std::endl;
+      return false;
+    }
+    ready = true;
+    return true;
+  }
+
+  void read(std::vector<ReadRequest>& requests) override {
+    for (ReadRequest& req : requests) req.ok = false;
+    if (!ready) {
+      // the ring broke in an earlier batch
+      for (ReadRequest& req : requests) req.ok = readFully(fd, req, 0);
+      return;
+    }
+    size_t submitted = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+      io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+      if (sqe == nullptr) {
+        // more requests than the ring holds, read the rest directly
+        requests[i].ok = readFully(fd, requests[i], 0);
+        continue;
+      }
+      io_uring_prep_read(sqe, fd, requests[i].dst, (unsigned)requests[i].bytes, requests[i].offset);
+      io_uring_sqe_set_data(sqe, &requests[i]);
+      submitted++;
+    }
+    if (submitted == 0) return;
+
+    size_t inFlight = 0;
+    while (inFlight < submitted) {
+      int n = io_uring_submit(&ring);
+      if (n <= 0) break;
+      inFlight += (size_t)n;
+    }
+    bool failed = inFlight < submitted;
+    for (size_t k = 0; k < inFlight; k++) {
+      io_uring_cqe* cqe = nullptr;
+      int err;
+      do {
+        err = io_uring_wait_cqe(&ring, &cqe);
+      } while (err == -EINTR);
+      if (err < 0) {
+        failed = true;
+        break;
+      }
+      ReadRequest& req = *static_cast<ReadRequest*>(io_uring_cqe_get_data(cqe));
+      int res = cqe->res;
+      io_uring_cqe_seen(&ring, cqe);
+      if (res < 0) {
+        req.ok = false;
+      } else if ((size_t)res < req.bytes && (size_t)res < req.need) {
+        req.ok = readFully(fd, req, (size_t)res);
+      } else {
+        req.ok = true;
+      }
+    }
+    if (failed) {
+      // entries left in the SQ ring would go out with the next batch, pointing
+      // into this one: drop the ring, this and every later batch use pread()
+      std::cerr << "Warning: io_uring failed, reading with pread() from now on." << std::endl;
+      io_uring_queue_exit(&ring);
+      ready = false;
+      for (ReadRequest& req : requests) {
+        if (!req.ok) req.ok = readFully(fd, req, 0);
+      }
+    }
+  }
+
+private:
+  int fd = -1;
+  io_uring ring;
+  bool ready = false;
+};
+#endif
+
+/**
+ * @brief Reader of a backend, nullptr for IO_MMAP or a backend missing in this build
+ */
+std::unique_ptr<BlockReader> BlockReader::create(IOBackend backend) {
+  switch (backend) {
+    case IO_PREAD: return std::make_unique<PreadReader>();
+#ifdef HAVE_LIBURING
+    case IO_URING: return std::make_unique<UringReader>();
+#endif
+    default: return nullptr;
+  }
+}
@@ -0,0 +1,102 @@
+//=============================================================================
+//
+//   BlockStore - Memory-mapped packed block file
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "BlockStore.h"
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+BlockStore::~BlockStore() {
+  close();
+}
+
+/**
+ * @brief Map the packed file read-only
+ */
+bool BlockStore::open(const std::filesystem::path& path) {
+  close();
+
+  fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "Error: Could not open block store: " << path << std::endl;
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    std::cerr << "Error: Could not stat block store: " << path << std::endl;
+    close();
+    return false;
+  }
+  bytes = (uint64_t)st.st_size;
+  pageSize = (size_t)sysconf(_SC_PAGESIZE);
+  if (bytes == 0) {
+    return true;
+  }
+
+  void* p = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  if (p == MAP_FAILED) {
+    std::cerr << "Error: Could not map block store: " << path << std::endl;
+    close();
+    return false;
+  }
+  base = static_cast<const unsigned char*>(p);
+
+  // access pattern is block-wise random, kernel readahead across blocks only wastes I/O
+  madvise(p, bytes, MADV_RANDOM);
+  return true;
+}
+
+/**
+ * @brief Unmap the file
+ */
+void BlockStore::close() {
+  if (base != nullptr) {
+    munmap(const_cast<unsigned char*>(base), bytes);
+    base = nullptr;
+  }
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+  bytes = 0;
+}
+
+/**
+ * @brief Make the pages of a range resident
+ *
+ * Called on worker threads, so the main thread never page-faults inside
+ * glBufferSubData().
+ */
+void BlockStore::fault(uint64_t offset, uint64_t length) const {
+  if (base == nullptr || length == 0) return;
+#ifdef MADV_POPULATE_READ
+  uint64_t first = offset & ~(uint64_t)(pageSize - 1);
+  if (madvise(const_cast<unsigned char*>(base) + first, length + (offset - first), MADV_POPULATE_READ) == 0) {
+    return;
+  }
+#endif
+  // fallback: touch one byte per page
+  volatile unsigned char sink = 0;
+  for (uint64_t o = 0; o < length; o += pageSize) {
+    sink ^= base[offset + o];
+  }
+  sink ^= base[offset + length - 1];
+  (void)sink;
+}
+
+/**
+ * @brief Hint the kernel that a range is needed soon
+ */
+void BlockStore::willNeed(uint64_t offset, uint64_t length) const {
+  if (base == nullptr || length == 0) return;
+  uint64_t first = offset & ~(uint64_t)(pageSize - 1);
+  madvise(const_cast<unsigned char*>(base) + first, length + (offset - first), MADV_WILLNEED);
+}
@@ -0,0 +1,63 @@
+//=============================================================================
+//
+//   BudgetController - Frame time driven slot and point budgets
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "BudgetController.h"
+#include <algorithm>
+
+/**
+ * @brief Start with startSlots of [minSlots, maxSlots] and the full point budget
+ */
+void BudgetController::init(float targetMs_, int minSlots, int maxSlots_, int startSlots) {
+  targetMs = targetMs_;
+  slotMax = std::max(1, maxSlots_);
+  slotMin = std::min(std::max(1, minSlots), slotMax);
+  slotCount = std::min(std::max(startSlots, slotMin), slotMax);
+  scale = 1.0f;
+  smoothed = 0.0f;
+  first = true;
+  cooldown = 0;
+}
+
+/**
+ * @brief Feed the time of the last frame
+ * @return true if the slots or the point scale changed
+ */
+bool BudgetController::update(float frameMs) {
+  if (!enabled() || frameMs <= 0.0f) return false;
+  smoothed = first ? frameMs : smoothed + BUDGET_SMOOTHING * (frameMs - smoothed);
+  first = false;
+  if (cooldown > 0) {
+    cooldown--;
+    return false;
+  }
+
+  if (smoothed > targetMs * (1.0f + BUDGET_HYSTERESIS)) {
+    // too slow: detail first, then blocks
+    if (scale > BUDGET_MIN_POINT_SCALE) {
+      scale = std::max(BUDGET_MIN_POINT_SCALE, scale * BUDGET_DECREASE);
+    } else if (slotCount > slotMin) {
+      slotCount = std::max(slotMin, std::min(slotCount - 1, (int)((float)slotCount * BUDGET_DECREASE)));
+    } else {
+      return false;
+    }
+  } else if (smoothed < targetMs * (1.0f - BUDGET_HYSTERESIS)) {
+    // headroom: blocks back first, then detail
+    if (slotCount < slotMax) {
+      int step = std::max(1, (int)(BUDGET_INCREASE * (float)(slotMax - slotMin)));
+      slotCount = std::min(slotMax, slotCount + step);
+    } else if (scale < 1.0f) {
+      scale = std::min(1.0f, scale + BUDGET_INCREASE);
+    } else {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  cooldown = BUDGET_COOLDOWN_FRAMES;
+  return true;
+}
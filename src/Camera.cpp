@@ -124,6 +124,17 @@ void Camera::changePose(const glm::vec3 &position, const glm::vec3 &target) {
   // std::cout << "Pitch: " << Pitch << std::endl; // "nodding"
 }
 
+/**
+ * @brief Set position, Euler angles and zoom directly
+ */
+void Camera::setPose(const glm::vec3 &position, float yaw, float pitch, float zoom) {
+  Position = position;
+  Yaw = yaw;
+  Pitch = pitch;
+  Zoom = zoom;
+  updateCameraVectors();
+}
+
 /**
  * @brief Update Yaw/Pitch based on current position when watching the target
  */
@@ -0,0 +1,82 @@
+//=============================================================================
+//
+//   CameraPath - Recorded camera poses, one per frame
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "CameraPath.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+
+/**
+ * @brief Append the current pose of the camera
+ */
+void CameraPath::record(const Camera& camera) {
+  poses.push_back({ camera.Position, camera.Yaw, camera.Pitch, camera.Zoom });
+}
+
+/**
+ * @brief Set the camera to the pose of a frame
+ * @return false if the path has no pose for this frame
+ */
+bool CameraPath::apply(size_t frame, Camera& camera) const {
+  if (frame >= poses.size()) return false;
+  const CameraPose& p = poses[frame];
+  camera.setPose(p.position, p.yaw, p.pitch, p.zoom);
+  return true;
+}
+
+/**
+ * @brief Read a path from a file
+ */
+bool CameraPath::load(const std::filesystem::path& path) {
+  std::ifstream is(path);
+  if (!is.is_open()) {
+    std::cerr << "Error: Could not open camera path: " << path << std::endl;
+    return false;
+  }
+  poses.clear();
+  std::string line;
+  int lineNo = 0;
+  while (std::getline(is, line)) {
+    lineNo++;
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream ls(line);
+    CameraPose p;
+    if (!(ls >> p.position.x >> p.position.y >> p.position.z >> p.yaw >> p.pitch >> p.zoom)) {
+      std::cerr << "Error: " << path << ":" << lineNo << ": expected x y z yaw pitch zoom" << std::endl;
+      return false;
+    }
+    poses.push_back(p);
+  }
+  if (poses.empty()) {
+    std::cerr << "Error: Camera path " << path << " has no poses." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Write the path to a file
+ */
+bool CameraPath::save(const std::filesystem::path& path) const {
+  std::ofstream os(path, std::ios::trunc);
+  if (!os.is_open()) {
+    std::cerr << "Error: Could not write camera path: " << path << std::endl;
+    return false;
+  }
+  // exact round trip of the floats, so a replay renders the recorded views
+  os << std::setprecision(std::numeric_limits<float>::max_digits10);
+  os << "# x y z yaw pitch zoom, one line per frame\n";
+  for (const CameraPose& p : poses) {
+    os << p.position.x << " " << p.position.y << " " << p.position.z << " "
+       << p.yaw << " " << p.pitch << " " << p.zoom << "\n";
+  }
+  std::cout << "Camera path of " << poses.size() << " frames written to " << path << std::endl;
+  return true;
+}
@@ -0,0 +1,239 @@
+//=============================================================================
+//
+//   ComputeRasterizer - Point rasterization with compute shaders and atomics
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "ComputeRasterizer.h"
+#include "GLExt.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+constexpr GLuint RASTER_GROUP = 256; // local_size_x of compute_raster.comp
+
+/**
+ * @brief Name of a backend, as on the command line
+ */
+const char* renderBackendName(RenderBackend backend) {
+  return backend == RENDER_COMPUTE ? "compute" : "points";
+}
+
+/**
+ * @brief Parse points|compute
+ */
+bool parseRenderBackend(const std::string& name, RenderBackend& backend) {
+  if (name == "points") { backend = RENDER_POINTS; return true; }
+  if (name == "compute") { backend = RENDER_COMPUTE; return true; }
+  return false;
+}
+
+/**
+ * @brief Read a shader file and put the defines right after its #version line
+ */
+static bool readShader(const char* path, const std::string& defines, std::string& out) {
+  std::ifstream file(path);
+  if (!file) {
+    std::cerr << "Error: Could not open shader " << path << std::endl;
+    return false;
+  }
+  std::stringstream ss;
+  ss << file.rdbuf();
+  out = ss.str();
+  size_t eol = out.find('\n');
+  out.insert(eol == std::string::npos ? out.size() : eol + 1, defines);
+  return true;
+}
+
+/**
+ * @brief Compile and link one program from the given stages, 0 on failure
+ */
+static GLuint buildProgram(const std::vector<std::pair<GLenum, std::string>>& stages, const char* name) {
+  GLuint prog = glCreateProgram();
+  std::vector<GLuint> shaders;
+  bool ok = true;
+  for (const auto& st : stages) {
+    GLuint s = glCreateShader(st.first);
+    const char* src = st.second.c_str();
+    glShaderSource(s, 1, &src, nullptr);
+    glCompileShader(s);
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(s, GL_COMPILE_STATUS, &compiled);
+    if (compiled != GL_TRUE) {
+      char log[1024];
+      glGetShaderInfoLog(s, sizeof(log), nullptr, log);
+      std::cerr << "Error: Could not compile " << name << ":\n" << log << std::endl;
+      ok = false;
+    }
+    glAttachShader(prog, s);
+    shaders.push_back(s);
+  }
+  if (ok) {
+    glLinkProgram(prog);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(prog, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE) {
+      char log[1024];
+      glGetProgramInfoLog(prog, sizeof(log), nullptr, log);
+      std::cerr << "Error: Could not link " << name << ":\n" << log << std::endl;
+      ok = false;
+    }
+  }
+  for (GLuint s : shaders) glDeleteShader(s);
+  if (!ok) {
+    glDeleteProgram(prog);
+    return 0;
+  }
+  return prog;
+}
+
+/**
+ * @brief Compile the shaders and allocate the framebuffer
+ */
+bool ComputeRasterizer::init(int width_, int height_, const char* computePath, const char* resolveVert, const char* resolveFrag) {
+  if (!glCaps.compute) {
+    std::cerr << "Error: The compute backend needs OpenGL 4.3, the context has "
+              << glCaps.major << "." << glCaps.minor << "." << std::endl;
+    return false;
+  }
+  atomic64 = glCaps.atomic64;
+
+  std::string comp, vert, frag;
+  if (!readShader(computePath, atomic64 ? "#define ATOMIC64 1\n" : "", comp)) return false;
+  if (!readShader(resolveVert, "", vert) || !readShader(resolveFrag, "", frag)) return false;
+  rasterProg = buildProgram({ { GL_COMPUTE_SHADER, comp } }, computePath);
+  resolveProg = buildProgram({ { GL_VERTEX_SHADER, vert }, { GL_FRAGMENT_SHADER, frag } }, resolveFrag);
+  if (rasterProg == 0 || resolveProg == 0) {
+    destroy();
+    return false;
+  }
+
+  locViewProj = glGetUniformLocation(rasterProg, "ViewProj");
+  locSize = glGetUniformLocation(rasterProg, "Size");
+  locBlockMin = glGetUniformLocation(rasterProg, "BlockMin");
+  locBlockExtent = glGetUniformLocation(rasterProg, "BlockExtent");
+  locPointsPerRegion = glGetUniformLocation(rasterProg, "PointsPerRegion");
+  locPass = glGetUniformLocation(rasterProg, "Pass");
+  locResolveSize = glGetUniformLocation(resolveProg, "Size");
+  glUseProgram(rasterProg);
+  glUniform1i(glGetUniformLocation(rasterProg, "RegionFrames"), 0);
+  glUseProgram(0);
+
+  glGenBuffers(1, &frameBuf);
+  glGenBuffers(1, &drawBuf);
+  glGenVertexArrays(1, &emptyVAO);
+  resize(width_, height_);
+  return true;
+}
+
+/**
+ * @brief Delete all GL objects
+ */
+void ComputeRasterizer::destroy() {
+  if (rasterProg != 0) glDeleteProgram(rasterProg);
+  if (resolveProg != 0) glDeleteProgram(resolveProg);
+  if (frameBuf != 0) glDeleteBuffers(1, &frameBuf);
+  if (drawBuf != 0) glDeleteBuffers(1, &drawBuf);
+  if (emptyVAO != 0) glDeleteVertexArrays(1, &emptyVAO);
+  rasterProg = resolveProg = frameBuf = drawBuf = emptyVAO = 0;
+}
+
+/**
+ * @brief Reallocate the framebuffer if the size changed
+ */
+void ComputeRasterizer::resize(int width_, int height_) {
+  if (width_ == width && height_ == height) return;
+  width = std::max(1, width_);
+  height = std::max(1, height_);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, frameBuf);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)width * height * 2 * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/**
+ * @brief Start a frame: clear the framebuffer, set the camera
+ */
+void ComputeRasterizer::begin(const glm::mat4& viewProj) {
+  // all ones: farthest depth, the resolve skips these pixels
+  const GLuint ones = 0xffffffffu;
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, frameBuf);
+  glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &ones);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  glUseProgram(rasterProg);
+  glUniformMatrix4fv(locViewProj, 1, GL_FALSE, &viewProj[0][0]);
+  glUniform2i(locSize, width, height);
+}
+
+/**
+ * @brief Rasterize count points of one block buffer (in-core)
+ */
+void ComputeRasterizer::drawBuffer(GLuint vbo, int count, const glm::vec3& bb_min, const glm::vec3& bb_max) {
+  if (count <= 0) return;
+  glUseProgram(rasterProg);
+  glUniform1i(locPointsPerRegion, 0);
+  glUniform3fv(locBlockMin, 1, &bb_min[0]);
+  glm::vec3 extent = bb_max - bb_min;
+  glUniform3fv(locBlockExtent, 1, &extent[0]);
+  draws.assign({ 0u, (GLuint)count });
+  dispatch(vbo, 1, (GLuint)count);
+}
+
+/**
+ * @brief Rasterize ranges of the slot arena, one per draw
+ */
+void ComputeRasterizer::drawRegions(GLuint vbo, int pointsPerRegion, const std::vector<GLint>& first, const std::vector<GLsizei>& count) {
+  if (first.empty()) return;
+  glUseProgram(rasterProg);
+  glUniform1i(locPointsPerRegion, pointsPerRegion);
+  draws.resize(2 * first.size());
+  GLuint maxCount = 0;
+  for (size_t i = 0; i < first.size(); i++) {
+    draws[2 * i] = (GLuint)first[i];
+    draws[2 * i + 1] = (GLuint)count[i];
+    maxCount = std::max(maxCount, (GLuint)count[i]);
+  }
+  dispatch(vbo, (GLuint)first.size(), maxCount);
+}
+
+/**
+ * @brief Dispatch over the draws in drawBuf, both passes without 64-bit atomics
+ */
+void ComputeRasterizer::dispatch(GLuint vbo, GLuint numDraws, GLuint maxCount) {
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawBuf);
+  // orphan the previous list, the GPU may still be reading it
+  glBufferData(GL_SHADER_STORAGE_BUFFER, draws.size() * sizeof(GLuint), draws.data(), GL_STREAM_DRAW);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, vbo);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, drawBuf);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, frameBuf);
+
+  GLuint groups = (maxCount + RASTER_GROUP - 1) / RASTER_GROUP;
+  if (atomic64) {
+    glDispatchCompute(groups, numDraws, 1);
+  } else {
+    glUniform1i(locPass, 0);
+    glDispatchCompute(groups, numDraws, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glUniform1i(locPass, 1);
+    glDispatchCompute(groups, numDraws, 1);
+  }
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+/**
+ * @brief Write the framebuffer into color and depth of the bound framebuffer
+ */
+void ComputeRasterizer::resolve() {
+  glUseProgram(resolveProg);
+  glUniform2i(locResolveSize, width, height);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, frameBuf);
+  glBindVertexArray(emptyVAO);
+  glDepthFunc(GL_ALWAYS);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  glDepthFunc(GL_LESS);
+  glBindVertexArray(0);
+}
@@ -20,6 +20,10 @@
 #include <string>
 #include <sstream>
 #include <filesystem>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+#include <atomic>
 
 DataManager::DataManager() {}
 
@@ -29,6 +33,9 @@ DataManager::DataManager() {}
 bool DataManager::init(const std::filesystem::path& plyPath,
                        const std::filesystem::path& outDir_,
                        bool isOOC_,
+                       bool forceRebuild,
+                       const PartitionConfig& partitionConfig_,
+                       int numWorkers,
                        glm::vec3& bb_min_,
                        glm::vec3& bb_max_,
                        std::vector<Block>& blocks,
@@ -36,9 +43,187 @@ bool DataManager::init(const std::filesystem::path& plyPath,
 {
   // Store outDir
   outDir = outDir_;
+  partitionConfig = partitionConfig_;
 
-  // Clean up old block files (rm ../data/*.bin)
+  // identify the source, so block files of a previous run can be reused
+  Manifest source;
+  if (!source.describeSource(plyPath, partitionConfig)) {
+    return false;
+  }
+
+  if (forceRebuild || !restoreBlocks(source, bb_min_, bb_max_, blocks, vertexCount)) {
+    if (!partition(plyPath, source, bb_min_, bb_max_, blocks, vertexCount, isOOC_)) {
+      return false;
+    }
+  }
+
+  if (!store.open(packPath())) {
+    return false;
+  }
+
+  // Out-of-core and in-core
+  if (isOOC_){
+    // the main thread never waits on the ring: cancelled results that do not
+    // fit go to cancelledQ, so the size only decides how often workers yield
+    resultQ.init(std::max<size_t>(RESULT_RING_MIN, num_blocks));
+
+    // one reader per worker, opened here so a bad backend fails init
+    numWorkers = std::max(1, numWorkers);
+    io.depth = std::max(1, io.depth);
+    std::vector<std::unique_ptr<BlockReader>> readers(numWorkers);
+    if (io.backend != IO_MMAP) {
+      for (auto& reader : readers) {
+        reader = BlockReader::create(io.backend);
+        if (reader == nullptr || !reader->open(packPath(), io.direct, io.depth)) {
+          std::cerr << "Error: I/O backend " << ioBackendName(io.backend) << " not available." << std::endl;
+          return false;
+        }
+      }
+      std::cout << "I/O backend: " << ioBackendName(io.backend) << ", " << io.depth << " reads per batch"
+                << (readers[0]->isDirect() ? ", O_DIRECT" : "") << std::endl;
+    }
+
+    // buffers for blocks that cannot be handed out as a pointer into the mapping
+    int maxCount = 0;
+    uint64_t maxStored = 0;
+    for (const BlockEntry& e : manifest.blocks) {
+      maxCount = std::max(maxCount, e.count);
+      maxStored = std::max(maxStored, e.bytes);
+    }
+    if (io.backend != IO_MMAP) {
+      // a worker holds at most a batch of buffers, so one worker always gets its batch
+      loadPool.init(numWorkers * (io.depth + DECODE_BUFFERS_PER_WORKER), (size_t)maxCount * sizeof(PointQ) + 2 * IO_ALIGN, IO_ALIGN);
+    } else if (partitionConfig.compression != COMPRESSION_NONE) {
+      loadPool.init(numWorkers * DECODE_BUFFERS_PER_WORKER, (size_t)maxCount * sizeof(PointQ));
+    }
+
+    // setup multi-threading workers for out-of-core load
+    workers.clear();
+    workers.reserve(numWorkers);
+    for (int i = 0; i < numWorkers; i++){
+      if (readers[i] != nullptr) {
+        workers.emplace_back(readerMain, i, std::ref(jobQ), std::ref(resultQ), std::move(readers[i]), std::ref(loadPool),
+                             io.depth, (size_t)maxStored, profiler);
+      } else {
+        workers.emplace_back(workerMain, i, std::ref(jobQ), std::ref(resultQ), std::cref(store), std::ref(loadPool), profiler);
+      }
+    }
+  } else {
+    // blocks are loaded by loadInCore(), once the rasterizer has buffers for them
+    numLoaders = std::max(1, numWorkers);
+  }
+
+  return true;
+}
+
+/**
+ * @brief Load all given blocks for in-core rendering and hand them to upload
+ *
+ * numLoaders threads fault the blocks in (or decode them) in parallel while
+ * the calling thread uploads the ones that are ready, so disk, decoding and
+ * the GPU upload overlap. Raw blocks are handed out as pointers into the
+ * mapping and compressed ones are decoded into a few buffers of loadPool,
+ * so no block is ever copied into a heap vector of its own.
+ *
+ * @param upload called on the calling thread with the index into blocks and
+ *               the points of the block, which are valid only during the call
+ * @return false if a block could not be loaded
+ */
+bool DataManager::loadInCore(const std::vector<Block>& blocks, const std::function<void(int, const PointQ*)>& upload) {
+  const int n = (int)blocks.size();
+  if (n == 0) return true;
+  const int numThreads = std::min(numLoaders, n);
+
+  if (partitionConfig.compression != COMPRESSION_NONE) {
+    int maxCount = 0;
+    for (const Block& b : blocks) maxCount = std::max(maxCount, b.count);
+    loadPool.init(numThreads * DECODE_BUFFERS_PER_WORKER, (size_t)maxCount * sizeof(PointQ));
+  }
+  resultQ.init(std::max<size_t>(RESULT_RING_MIN, (size_t)n)); // loaders never wait for a free cell
+
+  std::atomic<int> next{0};
+  std::vector<std::thread> loaders;
+  loaders.reserve(numThreads);
+  for (int i = 0; i < numThreads; i++) {
+    loaders.emplace_back([this, &blocks, &next, n]() {
+      std::vector<unsigned char> scratch;
+      for (int k = next.fetch_add(1); k < n; k = next.fetch_add(1)) {
+        Job job = jobFor(blocks[k].blockID, 0, blocks[k].count);
+        Result r = resultFor(job);
+        r.slotIdx = k; // in-core has no slots, remember the index into blocks instead
+        loadBlock(store, job, r, loadPool, scratch);
+        resultQ.push(std::move(r));
+      }
+    });
+  }
+
+  bool ok = true;
+  for (int done = 0; done < n; done++) {
+    Result r;
+    if (!resultQ.pop(r)) break;
+    if (r.points != nullptr) {
+      upload(r.slotIdx, r.points);
+    } else {
+      ok = false;
+    }
+    releaseResult(r); // the loader waiting for a decode buffer continues
+  }
+  for (auto& t : loaders) t.join();
+  return ok;
+}
+
+/**
+ * @brief Reuse blocks of a previous run if the stored manifest matches the source
+ *
+ * Block files are only checked for presence and size, their content is trusted.
+ * @return true if blocks, bbox and vertexCount were restored from the manifest
+ */
+bool DataManager::restoreBlocks(const Manifest& source, glm::vec3& bb_min_, glm::vec3& bb_max_, std::vector<Block>& blocks, uint64_t& vertexCount_)
+{
+  Manifest stored;
+  if (!stored.read(manifestPath()) || !stored.matches(source) ||
+      stored.blocks.empty() || stored.blocks.size() > (size_t)MAX_BLOCKS) {
+    return false;
+  }
+
+  std::error_code ec;
+  uint64_t packSize = std::filesystem::file_size(packPath(), ec);
+  int n = (int)stored.blocks.size();
+  for (int id = 0; id < n; ++id) {
+    const BlockEntry& e = stored.blocks[id];
+    if (ec || e.offset + e.bytes > packSize) {
+      std::cout << "Block store in " << outDir << " is incomplete, rebuilding." << std::endl;
+      return false;
+    }
+  }
+
+  num_blocks = (unsigned int)n;
+  blocks.assign(n, Block());
+  for (int id = 0; id < n; ++id) {
+    const BlockEntry& e = stored.blocks[id];
+    blocks[id].blockID = id;
+    blocks[id].count = e.count;
+    blocks[id].bb_min = e.bb_min;
+    blocks[id].bb_max = e.bb_max;
+  }
+  bb_min_ = stored.bb_min;
+  bb_max_ = stored.bb_max;
+  vertexCount = stored.vertexCount;
+  vertexCount_ = vertexCount;
+  manifest = std::move(stored);
+  std::cout << "Reusing block store in " << outDir << " (" << num_blocks << " blocks)." << std::endl;
+  return true;
+}
+
+/**
+ * @brief Partition the PLY file into block files and write a new manifest
+ */
+bool DataManager::partition(const std::filesystem::path& plyPath, const Manifest& source, glm::vec3& bb_min_, glm::vec3& bb_max_, std::vector<Block>& blocks, uint64_t& vertexCount_, bool isOOC_)
+{
+  // Clean up old block files (rm ../data/*.bin), the packed file and the manifest describing them
   if (std::filesystem::exists(outDir)) {
+    std::filesystem::remove(manifestPath());
+    std::filesystem::remove(packPath());
     for (const auto &entry : std::filesystem::directory_iterator(outDir)) {
       if (entry.path().extension() == ".bin") {
         std::filesystem::remove(entry.path());
@@ -48,11 +233,21 @@ bool DataManager::init(const std::filesystem::path& plyPath,
   }
 
   // reads .ply
-  if (!readPLY(plyPath, bb_min_, bb_max_, vertexCount)){
+  if (!readPLY(plyPath, bb_min_, bb_max_, vertexCount_)){
     std::cerr << "Error: Failed to do readPLY()" <<  std::endl;
     return false;
   }
 
+  // split space into blocks, using the bbox samples
+  if (!partitioner.build(partitionConfig, bb_min_, bb_max_, samples, vertexCount_)) {
+    std::cerr << "Error: Failed to build the partition" << std::endl;
+    return false;
+  }
+  samples.clear();
+  samples.shrink_to_fit();
+  num_blocks = (unsigned int)partitioner.numBlocks();
+  blocks.assign(num_blocks, Block());
+
   // sets up LRU cache for file writes when creating block files
   if (!cache.init(CACHE_SIZE)) {
     std::cerr << "Error: Failed to initialize cache." << std::endl;
@@ -65,87 +260,238 @@ bool DataManager::init(const std::filesystem::path& plyPath,
     return false;
   }
 
-  // Out-of-core and in-core
-  if (isOOC_){
-    // setup multi-threading workers for out-of-core load
-    workers.clear();
-    workers.reserve(NUM_WORKERS);
-    for (int i = 0; i < NUM_WORKERS; i++){
-      workers.emplace_back(workerMain, i, std::ref(jobQ), std::ref(resultQ));
-    }
-  } else {
-    // all block points in-core.
-    for (int id = 0; id < NUM_BLOCKS; id++){
-      loadBlock(pathFor(id), blocks[id].count, blocks[id].points);
-    }
+  // remember what we built
+  manifest = source;
+  manifest.vertexCount = vertexCount;
+  manifest.bb_min = bb_min_;
+  manifest.bb_max = bb_max_;
+  manifest.blocks.resize(num_blocks);
+  for (int id = 0; id < (int)num_blocks; ++id) {
+    manifest.blocks[id].count = blocks[id].count;
+    manifest.blocks[id].bb_min = blocks[id].bb_min;
+    manifest.blocks[id].bb_max = blocks[id].bb_max;
+  }
+
+  // one packed file instead of num_blocks small ones
+  if (!packBlocks()) {
+    std::cerr << "Error: Failed to do packBlocks()" << std::endl;
+    return false;
   }
 
+  if (!manifest.write(manifestPath())) {
+    // not fatal, the next launch simply partitions again
+    std::cerr << "Warning: Block store manifest not written." << std::endl;
+  }
   return true;
 }
 
 /**
- * @brief reads a .ply file and compute a global bbox
+ * @brief Get manifest path in outDir
+ */
+std::filesystem::path DataManager::manifestPath() const {
+  return outDir / "blocks.manifest";
+}
+
+/**
+ * @brief Get packed block file path in outDir
+ */
+std::filesystem::path DataManager::packPath() const {
+  return outDir / "blocks.pack";
+}
+
+/**
+ * @brief Quantize the per-block files into the packed file
+ *
+ * Positions are quantized against the block's tight bbox (see PointQ) and
+ * the points are stored in progressive order (see progressiveOrder), so any
+ * prefix of a block is a uniform subsample. Each block starts at a multiple
+ * of BLOCK_ALIGN. The per-block files are removed once they are converted.
  *
+ * With compression every CHUNK_POINTS points of the ordered block are
+ * compressed on their own (see encodeChunk), so a prefix of the block
+ * still decodes from a prefix of the stored bytes.
  */
-bool DataManager::readPLY(const std::filesystem::path& plyPath, glm::vec3& bb_min_, glm::vec3& bb_max_, uint64_t & vertexCount_)
+bool DataManager::packBlocks()
 {
-  std::ifstream file(plyPath, std::ios::binary);
-  if (!file.is_open()) {
-    std::cerr << "Error: Could not open PLY file: " << plyPath << std::endl;
+  std::ofstream os(packPath(), std::ios::binary | std::ios::trunc);
+  if (!os.is_open()) {
+    std::cerr << "Error: Could not create packed block file: " << packPath() << std::endl;
     return false;
   }
 
-  // parse header
-  std::string line, word, format;
-  bool headerEnded = false;
-
-  while (std::getline(file, line)) {
-    std::stringstream ss(line);
-    ss >> word;
-    if (word == "format") {
-      ss >> format;
-    } else if (word == "element") {
-      std::string what;
-      ss >> what;
-      if (what == "vertex")
-        ss >> vertexCount;
-    } else if (word == "end_header") {
-      headerEnded = true;
-      break;
+  std::vector<Point> in(INGEST_CHUNK);
+  std::vector<PointQ> out;
+  std::vector<unsigned char> planes, packed; // compression only
+  const std::vector<char> zeros(BLOCK_ALIGN, 0);
+  uint64_t offset = 0;
+  for (int id = 0; id < (int)num_blocks; ++id) {
+    BlockEntry& e = manifest.blocks[id];
+    e.offset = offset;
+    e.bytes = 0;
+    if (e.count == 0) {
+      std::filesystem::remove(pathFor(id));
+      continue;
+    }
+
+    std::ifstream is(pathFor(id), std::ios::binary);
+    if (!is.is_open()) {
+      std::cerr << "Error: Could not open block file: " << pathFor(id) << std::endl;
+      return false;
+    }
+    // the whole block is needed for the reordering, quantized it is half the size
+    glm::vec3 scale = quantizeScale(e.bb_min, e.bb_max);
+    out.resize((size_t)e.count);
+    uint64_t done = 0;
+    while (done < (uint64_t)e.count) {
+      uint64_t take = std::min<uint64_t>((uint64_t)e.count - done, in.size());
+      is.read(reinterpret_cast<char *>(in.data()), (std::streamsize)(take * sizeof(Point)));
+      if ((uint64_t)is.gcount() != take * sizeof(Point)) {
+        std::cerr << "Error: Incomplete read from block file: " << pathFor(id) << std::endl;
+        return false;
+      }
+      for (uint64_t i = 0; i < take; ++i) {
+        out[done + i] = quantizePoint(in[i], e.bb_min, scale);
+      }
+      done += take;
+    }
+    is.close();
+    progressiveOrder(out);
+    e.chunks.clear();
+    if (partitionConfig.compression == COMPRESSION_NONE) {
+      e.bytes = (uint64_t)e.count * sizeof(PointQ);
+      os.write(reinterpret_cast<const char *>(out.data()), (std::streamsize)e.bytes);
+    } else {
+      packed.clear();
+      for (size_t first = 0; first < out.size(); first += CHUNK_POINTS) {
+        e.chunks.push_back((uint32_t)packed.size());
+        if (!encodeChunk(partitionConfig.compression, out.data() + first, std::min(CHUNK_POINTS, out.size() - first), planes, packed)) {
+          return false;
+        }
+      }
+      e.chunks.push_back((uint32_t)packed.size());
+      e.bytes = packed.size();
+      os.write(reinterpret_cast<const char *>(packed.data()), (std::streamsize)e.bytes);
     }
+    std::filesystem::remove(pathFor(id));
+
+    offset += e.bytes;
+    uint64_t pad = (BLOCK_ALIGN - offset % BLOCK_ALIGN) % BLOCK_ALIGN;
+    os.write(zeros.data(), (std::streamsize)pad);
+    offset += pad;
   }
 
-  if (!headerEnded || vertexCount == 0) {
-    std::cerr << "Error: Invalid PLY header in file: " << plyPath << std::endl;
+  os.close();
+  if (os.fail()) {
+    std::cerr << "Error: Failed to write packed block file: " << packPath() << std::endl;
     return false;
   }
-  if (format != "binary_little_endian") {
-    std::cerr << "Only binary_little_endian supported in this fast path.\n";
-    return false;
+  if (partitionConfig.compression != COMPRESSION_NONE) {
+    uint64_t raw = 0, stored = 0;
+    for (const BlockEntry& e : manifest.blocks) {
+      raw += (uint64_t)e.count * sizeof(PointQ);
+      stored += e.bytes;
+    }
+    std::cout << "Compressed blocks (" << compressionName(partitionConfig.compression) << "): "
+              << stored / (1024 * 1024) << " of " << raw / (1024 * 1024) << " MB" << std::endl;
   }
+  return true;
+}
+
+/**
+ * @brief Spread the 16 bits of v to every third bit of a 48-bit value
+ */
+static uint64_t spreadBits3(uint64_t v) {
+  v &= 0xFFFFull;
+  v = (v | (v << 16)) & 0x0000FF0000FFull;
+  v = (v | (v << 8)) & 0x00F00F00F00Full;
+  v = (v | (v << 4)) & 0x0C30C30C30C3ull;
+  v = (v | (v << 2)) & 0x249249249249ull;
+  return v;
+}
 
-  // IMPORTANT: remember where binary vertex data begins
-  dataStart = file.tellg();
+/**
+ * @brief Reorder points so that every prefix is a uniform subsample of the block
+ *
+ * Points are sorted along a Morton (z-order) curve and then emitted in
+ * bit-reversed index order: the first 2^k points are every (n/2^k)-th point
+ * along the curve, i.e. spread evenly over the block. Loading or drawing a
+ * prefix therefore gives a coarser version of the block instead of a
+ * truncated one.
+ */
+void DataManager::progressiveOrder(std::vector<PointQ>& points)
+{
+  const size_t n = points.size();
+  if (n < 3) return;
+
+  std::vector<std::pair<uint64_t, uint32_t>> keys(n);
+  for (size_t i = 0; i < n; ++i) {
+    const PointQ& q = points[i];
+    uint64_t code = spreadBits3(q.x) | (spreadBits3(q.y) << 1) | (spreadBits3(q.z) << 2);
+    keys[i] = { code, (uint32_t)i };
+  }
+  std::sort(keys.begin(), keys.end());
+
+  int bits = 0;
+  while (((size_t)1 << bits) < n) bits++;
+
+  std::vector<PointQ> ordered;
+  ordered.reserve(n);
+  for (uint64_t k = 0; k < ((uint64_t)1 << bits); ++k) {
+    // reverse the lowest `bits` bits of k
+    uint64_t r = 0;
+    for (int b = 0; b < bits; ++b) r |= ((k >> b) & 1ull) << (bits - 1 - b);
+    if (r < n) ordered.push_back(points[keys[r].second]);
+  }
+  points.swap(ordered);
+}
 
-  // compute global bbox
-  std::vector<FilePoint> buf(BATCH);
+/**
+ * @brief reads a .ply header and estimates a global bbox from samples
+ *
+ */
+bool DataManager::readPLY(const std::filesystem::path& plyPath, glm::vec3& bb_min_, glm::vec3& bb_max_, uint64_t & vertexCount_)
+{
+  std::ifstream file(plyPath, std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Error: Could not open PLY file: " << plyPath << std::endl;
+    return false;
+  }
 
-  file.seekg(dataStart);
+  // parse header into the layout of the vertex records
+  if (!plyLayout.read(file) || !decoder.init(plyLayout)) {
+    std::cerr << "Error: Invalid PLY header in file: " << plyPath << std::endl;
+    return false;
+  }
+  vertexCount = plyLayout.vertexCount;
   vertexCount_ = vertexCount;
-  uint64_t remaining = vertexCount;
-  while (remaining > 0) {
-    uint64_t take = std::min<uint64_t>(remaining, buf.size());
-    file.read(reinterpret_cast<char *>(buf.data()), (std::streamsize)(take * sizeof(FilePoint)));
-    if ((uint64_t)file.gcount() != take * sizeof(FilePoint)) {
-      std::cerr << "Error: Failed to read vertex data (bbox pass) from: " << plyPath << std::endl;
+  const size_t stride = decoder.stride();
+  std::cout << "PLY: " << vertexCount << " vertices, " << stride << " bytes each, decoder: " << decoder.name() << std::endl;
+
+  // estimate global bbox from evenly spaced samples instead of a full pass.
+  // createBlocks() bins against this frame and computes the exact bbox on the way.
+  // The samples are kept, the k-d partitioner splits on them.
+  uint64_t take = std::min<uint64_t>(vertexCount, BBOX_SAMPLE_POINTS);
+  uint64_t numSamples = (vertexCount <= BBOX_SAMPLES * BBOX_SAMPLE_POINTS) ? (vertexCount + take - 1) / take : BBOX_SAMPLES;
+  std::vector<unsigned char> buf(take * stride);
+  std::vector<Point> decoded(take);
+  samples.clear();
+  samples.reserve(take * numSamples);
+
+  for (uint64_t s = 0; s < numSamples; ++s) {
+    uint64_t first = (numSamples > 1) ? s * (vertexCount - take) / (numSamples - 1) : 0;
+    file.clear();
+    file.seekg((std::streamoff)(plyLayout.dataOffset + first * stride));
+    file.read(reinterpret_cast<char *>(buf.data()), (std::streamsize)buf.size());
+    if ((uint64_t)file.gcount() != buf.size()) {
+      std::cerr << "Error: Failed to read vertex data (bbox samples) from: " << plyPath << std::endl;
       return false;
     }
 
+    decoder.decode(buf.data(), take, decoded.data());
     for (uint64_t i = 0; i < take; ++i) {
-      glm::vec3 p((float)buf[i].x, (float)buf[i].y, (float)buf[i].z);
-      bboxExpand(p, bb_min_, bb_max_);
+      bboxExpand(decoded[i].pos, bb_min_, bb_max_);
+      samples.push_back(decoded[i].pos);
     }
-    remaining -= take;
   }
 
   return true;
@@ -153,8 +499,14 @@ bool DataManager::readPLY(const std::filesystem::path& plyPath, glm::vec3& bb_mi
 
 /**
  * @brief Create spatial blocks from point cloud
+ *
+ * Single pass over the vertex data: the main thread reads large chunks,
+ * binner threads group each chunk by block (count + prefix sum + scatter)
+ * and one writer thread appends the groups to the block files. Points
+ * outside the estimated bbox are clamped into the border blocks; block and
+ * global bboxes are the exact bounds of the points they contain.
  */
-bool DataManager::createBlocks(const std::filesystem::path& plyPath, const glm::vec3& bb_min_, const glm::vec3& bb_max_, std::vector<Block>& blocks, bool isOOC_)
+bool DataManager::createBlocks(const std::filesystem::path& plyPath, glm::vec3& bb_min_, glm::vec3& bb_max_, std::vector<Block>& blocks, bool isOOC_)
 {
   std::ifstream file(plyPath, std::ios::binary);
   if (!file.is_open()) {
@@ -162,200 +514,521 @@ bool DataManager::createBlocks(const std::filesystem::path& plyPath, const glm::
     return false;
   }
 
-  // block size
-  glm::vec3 extent = bb_max_ - bb_min_;
-  glm::vec3 cell = extent / (float)GRID;
-
   // block bbox update
-  for (int z = 0; z < GRID; ++z) {
-    for (int y = 0; y < GRID; ++y) {
-      for (int x = 0; x < GRID; ++x) {
-        int id = x + GRID * y + GRID * GRID * z;
-
-        glm::vec3 mn = bb_min_ + glm::vec3(x, y, z) * cell;
-        glm::vec3 mx = bb_min_ + glm::vec3(x + 1, y + 1, z + 1) * cell;
-
-        blocks[id].blockID = id; // needed after we filter out empty blocks
-        blocks[id].bb_min = mn;
-        blocks[id].bb_max = mx;
-      }
-    }
+  for (int id = 0; id < (int)num_blocks; ++id) {
+    blocks[id].blockID = id; // needed after we filter out empty blocks
+    partitioner.cellBounds(id, blocks[id].bb_min, blocks[id].bb_max);
+    blocks[id].count = 0;
   }
   // write block files with LRU Cache
-  for (int id = 0; id < NUM_BLOCKS; ++id) {
+  for (int id = 0; id < (int)num_blocks; ++id) {
     cache.get(id, pathFor(id));
   }
 
-  std::vector<FilePoint> buf(BATCH);
-  std::array<std::vector<Point>, NUM_BLOCKS> outBuf;
-  for (auto &v : outBuf)
-    v.reserve(FLUSH_POINTS);
+  // set up the pipeline
+  int numBinners = std::max(1, (int)std::thread::hardware_concurrency() - 2);
+  int poolSize = numBinners + 2;
+
+  IngestPipeline pipe;
+  pipe.partitioner = &partitioner;
+  pipe.decoder = &decoder;
+  const size_t stride = decoder.stride();
+  for (int i = 0; i < poolSize; ++i) {
+    RawChunk raw;
+    raw.bytes.reserve(INGEST_CHUNK * stride);
+    pipe.freeRawQ.push(std::move(raw));
+
+    BinnedChunk binned;
+    binned.points.reserve(INGEST_CHUNK);
+    binned.offsets.reserve(num_blocks + 1);
+    pipe.freeBinnedQ.push(std::move(binned));
+  }
+
+  std::vector<BinStats> stats(numBinners);
+  std::vector<std::thread> binners;
+  binners.reserve(numBinners);
+  for (int i = 0; i < numBinners; ++i) {
+    binners.emplace_back(binnerMain, std::ref(pipe), std::ref(stats[i]));
+  }
+  bool writeOk = true;
+  std::thread writer(&DataManager::writerMain, this, std::ref(pipe), std::ref(writeOk));
 
+  // reader: this thread
   file.clear();
-  file.seekg(dataStart);
+  file.seekg((std::streamoff)plyLayout.dataOffset);
 
+  bool readOk = true;
   uint64_t remaining = vertexCount;
   while (remaining > 0) {
-    uint64_t take = std::min<uint64_t>(remaining, buf.size());
-    file.read(reinterpret_cast<char *>(buf.data()), static_cast<std::streamsize>(take * sizeof(FilePoint)));
-    if ((uint64_t)file.gcount() != take * sizeof(FilePoint)) {
+    RawChunk raw;
+    pipe.freeRawQ.pop(raw);
+    uint64_t take = std::min<uint64_t>(remaining, INGEST_CHUNK);
+    raw.bytes.resize(take * stride);
+    file.read(reinterpret_cast<char *>(raw.bytes.data()), static_cast<std::streamsize>(raw.bytes.size()));
+    if ((uint64_t)file.gcount() != raw.bytes.size()) {
       std::cerr << "Error: Failed to read vertex data (block creation pass) from: " << plyPath << std::endl;
-      return false;
+      readOk = false;
+      break;
     }
+    raw.n = take;
+    pipe.rawQ.push(std::move(raw));
+    remaining -= take;
+  }
 
-    for (uint64_t i = 0; i < take; ++i) {
-      const auto &fp = buf[i];
-      float x = (float)fp.x;
-      float y = (float)fp.y;
-      float z = (float)fp.z;
-
-      int ix = clampi((int)((x - bb_min_.x) / cell.x), 0, 9);
-      int iy = clampi((int)((y - bb_min_.y) / cell.y), 0, 9);
-      int iz = clampi((int)((z - bb_min_.z) / cell.z), 0, 9);
-      int id = ix + 10 * iy + 100 * iz;
+  // drain the pipeline
+  pipe.rawQ.stop();
+  for (auto& t : binners) t.join();
+  pipe.binnedQ.stop();
+  writer.join();
+  cache.close_all();
 
-      outBuf[id].push_back(Point{glm::vec3(x, y, z), glm::vec3(fp.r/255.0f, fp.g/255.0f, fp.b/255.0f)});
-      blocks[id].count++;
+  if (!readOk || !writeOk) {
+    return false;
+  }
 
-      if (outBuf[id].size() >= FLUSH_POINTS)
-        flush(id, outBuf);
+  // merge per-binner counts and tight bboxes
+  bb_min_ = glm::vec3(std::numeric_limits<float>::max());
+  bb_max_ = glm::vec3(std::numeric_limits<float>::lowest());
+  for (int id = 0; id < (int)num_blocks; ++id) {
+    glm::vec3 mn(std::numeric_limits<float>::max());
+    glm::vec3 mx(std::numeric_limits<float>::lowest());
+    int count = 0;
+    for (const auto& st : stats) {
+      if (st.counts.empty() || st.counts[id] == 0) continue;
+      count += st.counts[id];
+      mn = glm::min(mn, st.bb_min[id]);
+      mx = glm::max(mx, st.bb_max[id]);
+    }
+    blocks[id].count = count;
+    if (count > 0) {
+      blocks[id].bb_min = mn;
+      blocks[id].bb_max = mx;
+      bbox_expand(bb_min_, bb_max_, mn);
+      bbox_expand(bb_min_, bb_max_, mx);
     }
-    remaining -= take;
   }
 
-  // flush leftovers
-  for (int id = 0; id < NUM_BLOCKS; ++id){
-    flush(id, outBuf);
+  std::cout << "created " << num_blocks << " blocks with " << numBinners << " binner threads." << std::endl;
+  return true;
+}
+
+/**
+ * @brief Ingestion: group raw chunks by block
+ *
+ * The raw records are decoded first (see VertexDecoder), on the binners so
+ * the conversion runs in parallel. Then two passes over each chunk: count
+ * points per block, then scatter them to their prefix-sum offsets, so a
+ * block's points end up contiguous.
+ */
+void DataManager::binnerMain(IngestPipeline& pipe, BinStats& stats)
+{
+  const Partitioner& partitioner = *pipe.partitioner;
+  const int numBlocks = partitioner.numBlocks();
+  stats.counts.assign(numBlocks, 0);
+  stats.bb_min.assign(numBlocks, glm::vec3(std::numeric_limits<float>::max()));
+  stats.bb_max.assign(numBlocks, glm::vec3(std::numeric_limits<float>::lowest()));
+
+  std::vector<uint16_t> ids;
+  std::vector<uint32_t> cursor(numBlocks);
+  std::vector<Point> decoded;
+  static_assert(MAX_BLOCKS <= 65536, "block ids must fit in uint16_t");
+
+  RawChunk raw;
+  while (pipe.rawQ.pop(raw)) {
+    BinnedChunk out;
+    pipe.freeBinnedQ.pop(out);
+    out.points.resize(raw.n);
+    out.offsets.assign(numBlocks + 1, 0);
+    ids.resize(raw.n);
+    decoded.resize(raw.n);
+    pipe.decoder->decode(raw.bytes.data(), raw.n, decoded.data());
+
+    // count
+    for (uint64_t i = 0; i < raw.n; ++i) {
+      int id = partitioner.blockOf(decoded[i].pos);
+      ids[i] = (uint16_t)id;
+      out.offsets[id + 1]++;
+    }
+
+    // prefix sum
+    for (int id = 0; id < numBlocks; ++id) {
+      out.offsets[id + 1] += out.offsets[id];
+    }
+
+    // scatter
+    std::copy(out.offsets.begin(), out.offsets.end() - 1, cursor.begin());
+    for (uint64_t i = 0; i < raw.n; ++i) {
+      int id = ids[i];
+      out.points[cursor[id]++] = decoded[i];
+      stats.counts[id]++;
+      bbox_expand(stats.bb_min[id], stats.bb_max[id], decoded[i].pos);
+    }
+
+    pipe.freeRawQ.push(std::move(raw));
+    pipe.binnedQ.push(std::move(out));
   }
+}
 
-  cache.close_all();
-  std::cout << "created " << NUM_BLOCKS << " blocks." << std::endl;
-  return true;
+/**
+ * @brief Ingestion: append binned chunks to the block files
+ *
+ * The only thread touching the FileStreamCache while the pipeline runs.
+ */
+void DataManager::writerMain(IngestPipeline& pipe, bool& ok)
+{
+  BinnedChunk in;
+  while (pipe.binnedQ.pop(in)) {
+    for (int id = 0; id < (int)num_blocks; ++id) {
+      uint32_t first = in.offsets[id];
+      uint32_t last = in.offsets[id + 1];
+      if (first == last) continue;
+      ok &= flush(id, in.points.data() + first, last - first);
+    }
+    pipe.freeBinnedQ.push(std::move(in));
+  }
 }
 
 /**
  * @brief Enqueue block loading job
  */
-void DataManager::enqueueBlock(const int& blockID, const int& slotIdx, const int& count, const bool& loadToSlots) {
-  Job job;
-  job.blockID = blockID;
+void DataManager::enqueueBlock(const int& blockID, const int& slotIdx, const int& first, const int& count, const bool& loadToSlots, float priority, uint32_t generation, void* staging, int stagingIdx) {
+  Job job = jobFor(blockID, first, count);
   job.slotIdx = slotIdx;
-  job.count = count;
-  job.path = pathFor(blockID);
   job.loadToSlots = loadToSlots;
+  job.staging = staging;
+  job.stagingIdx = stagingIdx;
+  job.priority = priority;
+  job.generation = generation;
   jobQ.push(std::move(job));
 }
 
 /**
- * @brief Get file path for block ID
+ * @brief Job reading the points [first, first + count) of a block, where to put them is up to the caller
  */
-std::filesystem::path DataManager::pathFor(int id) {
-  char name[64];
-  std::snprintf(name, sizeof(name), "block_%04d.bin", id);
-  return outDir / name;
+Job DataManager::jobFor(int blockID, int first, int count) const {
+  Job job;
+  job.blockID = blockID;
+  job.slotIdx = -1;
+  job.first = first;
+  job.count = count;
+  job.loadToSlots = false;
+  const BlockEntry& e = manifest.blocks[blockID];
+  if (e.chunks.empty()) {
+    job.offset = e.offset + (uint64_t)first * sizeof(PointQ);
+  } else {
+    // compressed: the worker picks the chunks of [first, first + count)
+    job.offset = e.offset;
+    job.chunks = e.chunks.data();
+    job.compression = partitionConfig.compression;
+  }
+  job.blockCount = e.count;
+  return job;
 }
 
 /**
- * @brief Load block from file (for out-of-core rendering)
+ * @brief Re-key queued jobs and cancel stale ones
+ *
+ * Cancelled jobs come back as results without points (cancelled = true),
+ * so the caller can release whatever it reserved for them. This runs on the
+ * only consumer of resultQ, so it must not wait for a free cell: results
+ * that do not fit are kept in cancelledQ, tryGetResult() hands them out
+ * first.
  */
-void DataManager::loadBlock(const std::filesystem::path& path, const int & count, Result & r){
-  std::ifstream is(path, std::ios::binary);
-
-  /*ADDED ERROR HANDLING*/
-  if (!is.is_open()) {
-    std::cerr << "Error: Could not open block file: " << path << std::endl;
-    r.points.clear();
-    return;
-  }
-
-  r.points.resize(count);
-  is.read(reinterpret_cast<char *>(r.points.data()), count * sizeof(Point));
-
-  /*ADDED ERROR HANDLING*/
-  if (!is.good() && !is.eof()) {
-    std::cerr << "Error: Failed to read block data from: " << path << std::endl;
-    r.points.clear();
-    return;
-  }
-
-  /*ADDED ERROR HANDLING*/
-  if ((size_t)is.gcount() != count * sizeof(Point)) {
-    std::cerr << "Error: Incomplete read from block file: " << path
-              << " (expected " << count * sizeof(Point)
-              << " bytes, got " << is.gcount() << " bytes)" << std::endl;
-    r.points.clear();
-    return;
+int DataManager::rescheduleJobs(const std::function<void(Job&)>& refresh, uint32_t minGeneration) {
+  std::vector<Job> dropped;
+  jobQ.reschedule(refresh, minGeneration, dropped);
+  for (const Job& job : dropped) {
+    Result r = resultFor(job);
+    r.cancelled = true;
+    if (!cancelledQ.empty() || !resultQ.try_push(r)) cancelledQ.push_back(std::move(r));
   }
+  return (int)dropped.size();
 }
 
 /**
- * @brief Load block from file (for in-core rendering)
+ * @brief Get file path of the temporary per-block file used during partitioning
  */
-void DataManager::loadBlock(const std::filesystem::path& path, const int & count, std::vector<Point>& points){
-  std::ifstream is(path, std::ios::binary);
+std::filesystem::path DataManager::pathFor(int id) {
+  char name[64];
+  std::snprintf(name, sizeof(name), "block_%04d.bin", id);
+  return outDir / name;
+}
 
-  /*ADDED ERROR HANDLING*/
-  if (!is.is_open()) {
-    std::cerr << "Error: Could not open block file: " << path << std::endl;
-    points.clear();
+/**
+ * @brief Load block from the block store (for out-of-core rendering)
+ *
+ * Faults the pages in on the worker and hands out a pointer into the mapping.
+ * With a staging region the block is copied straight into the GPU-visible
+ * memory instead, which faults the pages in on the way. Compressed blocks
+ * are decoded into the staging region, or into a buffer of loadPool that
+ * the main thread gives back with releaseResult().
+ */
+void DataManager::loadBlock(const BlockStore& store, const Job& job, Result & r, BufferPool& loadPool, std::vector<unsigned char>& scratch){
+  if (job.chunks != nullptr) {
+    uint64_t stored = job.chunks[chunkCount((size_t)job.blockCount)];
+    if (job.offset + stored > store.size()) {
+      std::cerr << "Error: Block " << job.blockID << " lies outside the block store"
+                << " (offset " << job.offset << ", " << stored << " bytes)" << std::endl;
+      r.points = nullptr;
+      return;
+    }
+    PointQ* dst = static_cast<PointQ*>(job.staging);
+    if (dst == nullptr) {
+      r.bufferIdx = loadPool.acquire();
+      if (r.bufferIdx < 0) { // stopped while waiting
+        r.points = nullptr;
+        return;
+      }
+      dst = static_cast<PointQ*>(loadPool.data(r.bufferIdx));
+    }
+    uint64_t from = job.offset + job.chunks[(size_t)job.first / CHUNK_POINTS];
+    if (!decodeRange(job.compression, static_cast<const unsigned char*>(store.at(from)), job.chunks,
+                     (size_t)job.blockCount, (size_t)job.first, (size_t)job.count, dst, scratch)) {
+      std::cerr << "Error: Block " << job.blockID << " is corrupt in the block store" << std::endl;
+      loadPool.release(r.bufferIdx);
+      r.bufferIdx = -1;
+      r.points = nullptr;
+      return;
+    }
+    r.points = dst;
     return;
   }
 
-  points.resize(count);
-  is.read(reinterpret_cast<char *>(points.data()), count * sizeof(Point));
+  uint64_t bytes = (uint64_t)job.count * sizeof(PointQ);
 
   /*ADDED ERROR HANDLING*/
-  if (!is.good() && !is.eof()) {
-    std::cerr << "Error: Failed to read block data from: " << path << std::endl;
-    points.clear();
+  if (job.offset + bytes > store.size()) {
+    std::cerr << "Error: Block " << job.blockID << " lies outside the block store"
+              << " (offset " << job.offset << ", " << bytes << " bytes)" << std::endl;
+    r.points = nullptr;
     return;
   }
 
-  /*ADDED ERROR HANDLING*/
-  if ((size_t)is.gcount() != count * sizeof(Point)) {
-    std::cerr << "Error: Incomplete read from block file: " << path
-              << " (expected " << count * sizeof(Point)
-              << " bytes, got " << is.gcount() << " bytes)" << std::endl;
-    points.clear();
-    return;
+  r.points = static_cast<const PointQ*>(store.at(job.offset));
+  if (job.staging != nullptr) {
+    std::memcpy(job.staging, r.points, bytes);
+  } else {
+    store.fault(job.offset, bytes);
   }
 }
 
 /**
  * @brief Worker thread main function
  */
-void DataManager::workerMain(int workerID, Queue<Job>& jobQ, Queue<Result>& resultQ)
+void DataManager::workerMain(int workerID, JobScheduler& jobQ, RingQueue<Result>& resultQ, const BlockStore& store, BufferPool& loadPool, ProfilerCPU* profiler)
 {
+  if (profiler) profiler->setThreadName("worker " + std::to_string(workerID));
+  std::vector<unsigned char> scratch; // one decompressed chunk, kept for the whole run
+
   Job job;
+  uint64_t t0 = profiler ? profiler->now() : 0;
   while (jobQ.pop(job)) {
-
-    // Read binary file
-    Result r;
-    r.blockID = job.blockID;
-    r.slotIdx = job.slotIdx;
-    r.count = job.count;
-    r.loadToSlots = job.loadToSlots;
-    loadBlock(job.path, job.count, r);
+    if (profiler) profiler->record(Section::WorkerWait, t0, profiler->now());
+
+    // Fault the block in
+    Result r = resultFor(job);
+    {
+      uint64_t t1 = profiler ? profiler->now() : 0;
+      loadBlock(store, job, r, loadPool, scratch);
+      if (profiler) profiler->record(Section::WorkerIO, t1, profiler->now());
+    }
 
     // move to Result
     resultQ.push(std::move(r));
+    t0 = profiler ? profiler->now() : 0;
   }
   // jobQ.stop() called -> threads are over
 }
 
+/**
+ * @brief Worker thread main function with a BlockReader (pread, io_uring)
+ *
+ * Takes up to depth queued jobs at once and reads them in one batch, so the
+ * device sees depth reads per worker. Raw blocks are read straight into the
+ * staging region, or into a buffer of loadPool; compressed ones into a
+ * buffer of this worker first and decoded from there. With O_DIRECT every
+ * read is widened to IO_ALIGN and staged blocks go through loadPool.
+ */
+void DataManager::readerMain(int workerID, JobScheduler& jobQ, RingQueue<Result>& resultQ, std::unique_ptr<BlockReader> reader,
+                             BufferPool& loadPool, int depth, size_t maxStored, ProfilerCPU* profiler)
+{
+  if (profiler) profiler->setThreadName("worker " + std::to_string(workerID));
+  bool direct = reader->isDirect();
+  std::vector<unsigned char> scratch; // one decompressed chunk, kept for the whole run
+  BufferPool packed;                  // compressed bytes of a batch, only touched by this worker
+  packed.init(depth, maxStored + 2 * IO_ALIGN, IO_ALIGN);
+
+  struct Pending {
+    uint64_t lo = 0;     // first byte of the job in the file
+    int readBuf = -1;    // loadPool buffer read into
+    int packedBuf = -1;  // packed buffer read into
+  };
+  std::vector<Job> jobs;
+  std::vector<Result> results;
+  std::vector<Pending> pending;
+  std::vector<ReadRequest> requests;
+
+  uint64_t t0 = profiler ? profiler->now() : 0;
+  while (jobQ.popBatch(jobs, (size_t)depth)) {
+    if (profiler) profiler->record(Section::WorkerWait, t0, profiler->now());
+    uint64_t t1 = profiler ? profiler->now() : 0;
+
+    results.clear();
+    pending.assign(jobs.size(), Pending());
+    requests.clear();
+    std::vector<size_t> requestOf(jobs.size(), SIZE_MAX);
+    for (size_t i = 0; i < jobs.size(); i++) {
+      const Job& job = jobs[i];
+      results.push_back(resultFor(job));
+      Pending& p = pending[i];
+
+      uint64_t hi;
+      if (job.chunks != nullptr) {
+        p.lo = job.offset + job.chunks[(size_t)job.first / CHUNK_POINTS];
+        hi = job.offset + job.chunks[((size_t)job.first + std::max(job.count, 1) - 1) / CHUNK_POINTS + 1];
+      } else {
+        p.lo = job.offset;
+        hi = p.lo + (uint64_t)job.count * sizeof(PointQ);
+      }
+      uint64_t alo = direct ? p.lo / IO_ALIGN * IO_ALIGN : p.lo;
+      uint64_t ahi = direct ? (hi + IO_ALIGN - 1) / IO_ALIGN * IO_ALIGN : hi;
+
+      void* dst;
+      if (job.chunks != nullptr) {
+        p.packedBuf = packed.acquire();
+        dst = packed.data(p.packedBuf);
+      } else if (job.staging != nullptr && !direct) {
+        dst = job.staging;
+      } else {
+        p.readBuf = loadPool.acquire();
+        if (p.readBuf < 0) continue; // stopped while waiting, no points
+        dst = loadPool.data(p.readBuf);
+      }
+      ReadRequest req;
+      req.offset = alo;
+      req.bytes = (size_t)(ahi - alo);
+      req.need = (size_t)(hi - alo);
+      req.dst = dst;
+      requestOf[i] = requests.size();
+      requests.push_back(req);
+    }
+
+    reader->read(requests);
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+      const Job& job = jobs[i];
+      Result& r = results[i];
+      Pending& p = pending[i];
+      r.points = nullptr;
+      if (requestOf[i] == SIZE_MAX) continue;
+      const ReadRequest& req = requests[requestOf[i]];
+      const unsigned char* data = static_cast<const unsigned char*>(req.dst) + (p.lo - req.offset);
+      if (!req.ok) {
+        std::cerr << "Error: Could not read block " << job.blockID << " (offset " << p.lo << ")" << std::endl;
+        loadPool.release(p.readBuf);
+        packed.release(p.packedBuf);
+        continue;
+      }
+
+      if (job.chunks != nullptr) {
+        PointQ* dst = static_cast<PointQ*>(job.staging);
+        if (dst == nullptr) {
+          r.bufferIdx = loadPool.acquire();
+          if (r.bufferIdx >= 0) dst = static_cast<PointQ*>(loadPool.data(r.bufferIdx));
+        }
+        if (dst != nullptr && decodeRange(job.compression, data, job.chunks, (size_t)job.blockCount,
+                                          (size_t)job.first, (size_t)job.count, dst, scratch)) {
+          r.points = dst;
+        } else {
+          if (dst != nullptr) std::cerr << "Error: Block " << job.blockID << " is corrupt in the block store" << std::endl;
+          loadPool.release(r.bufferIdx);
+          r.bufferIdx = -1;
+        }
+        packed.release(p.packedBuf);
+      } else if (job.staging != nullptr) {
+        // O_DIRECT went through an aligned buffer, the GPU copies from the staging region
+        if (p.readBuf >= 0) {
+          std::memcpy(job.staging, data, (size_t)job.count * sizeof(PointQ));
+          loadPool.release(p.readBuf);
+        }
+        r.points = static_cast<const PointQ*>(job.staging);
+      } else {
+        r.bufferIdx = p.readBuf;
+        r.points = reinterpret_cast<const PointQ*>(data);
+      }
+    }
+    if (profiler) profiler->record(Section::WorkerIO, t1, profiler->now());
+
+    for (Result& r : results) resultQ.push(std::move(r));
+    t0 = profiler ? profiler->now() : 0;
+  }
+}
+
+/**
+ * @brief Result of a job, without points yet
+ */
+Result DataManager::resultFor(const Job& job) {
+  Result r;
+  r.blockID = job.blockID;
+  r.slotIdx = job.slotIdx;
+  r.first = job.first;
+  r.count = job.count;
+  r.loadToSlots = job.loadToSlots;
+  r.stagingIdx = job.stagingIdx;
+  return r;
+}
+
+/**
+ * @brief Hint that a block is likely to be requested soon
+ */
+void DataManager::prefetchBlock(const int& blockID, const int& count) {
+  if (io.direct) return; // O_DIRECT bypasses the page cache, readahead would be wasted
+  const BlockEntry& e = manifest.blocks[blockID];
+  uint64_t bytes = e.chunks.empty() ? (uint64_t)count * sizeof(PointQ) : e.chunks[chunkCount((size_t)std::min(count, e.count))];
+  store.willNeed(e.offset, bytes);
+}
+
 /**
  * @brief Get loaded block result from worker threads
  */
 void DataManager::getResult(Result& out) {
+  if (popCancelled(out)) return;
   resultQ.pop(out);
 }
 
+/**
+ * @brief Get loaded block result if one is ready, without blocking
+ */
+bool DataManager::tryGetResult(Result& out) {
+  return popCancelled(out) || resultQ.try_pop(out);
+}
+
+/**
+ * @brief Take the oldest cancelled result that did not fit into resultQ
+ */
+bool DataManager::popCancelled(Result& out) {
+  if (cancelledQ.empty()) return false;
+  out = std::move(cancelledQ.front());
+  cancelledQ.pop_front();
+  return true;
+}
+
+/**
+ * @brief Give the decode buffer of a consumed result back to the workers
+ */
+void DataManager::releaseResult(Result& r) {
+  loadPool.release(r.bufferIdx);
+  r.bufferIdx = -1;
+}
+
 /**
  * @brief Stop worker threads and cleanup
  */
 void DataManager::quit(){
   jobQ.stop();
+  loadPool.stop(); // a worker may wait for a buffer nobody returns anymore
   for (auto& t : workers) t.join();
+  workers.clear();
 }
 
 /**
@@ -377,22 +1050,22 @@ void DataManager::bboxExpand(const glm::vec3& p, glm::vec3& bb_min_, glm::vec3&
 }
 
 /**
- * @brief Flush point buffer to disk
+ * @brief Append points to the file of block id
+ * @return false if the write failed
  */
-void DataManager::flush(int id, std::array<std::vector<Point>, NUM_BLOCKS>& outBuf) {
-  auto &v = outBuf[id];
-  if (v.empty())
-    return;
+bool DataManager::flush(int id, const Point* points, size_t n) {
+  if (n == 0)
+    return true;
   auto &os = cache.get(id, pathFor(id));
-  os.write(reinterpret_cast<const char *>(v.data()), (std::streamsize)(v.size() * sizeof(Point)));
+  os.write(reinterpret_cast<const char *>(points), (std::streamsize)(n * sizeof(Point)));
 
   /*ADDED ERROR HANDLING*/
   if (!os.good()) {
     std::cerr << "Error: Failed to write block data to: " << pathFor(id)
-              << " (block " << id << ", " << v.size() << " points)" << std::endl;
+              << " (block " << id << ", " << n << " points)" << std::endl;
+    return false;
   }
-
-  v.clear();
+  return true;
 }
 
 // Previous readPLY
@@ -0,0 +1,150 @@
+//=============================================================================
+//
+//   EvictionPolicy - Replacement strategies for the subslots cache
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "EvictionPolicy.h"
+#include <algorithm>
+#include <limits>
+
+/**
+ * @brief Name of a policy, as on the command line
+ */
+const char* cachePolicyName(CachePolicy policy) {
+  switch (policy) {
+    case CACHE_2Q: return "2q";
+    case CACHE_COST: return "cost";
+    default: return "lru";
+  }
+}
+
+/**
+ * @brief Parse lru|2q|cost
+ */
+bool parseCachePolicy(const std::string& name, CachePolicy& policy) {
+  if (name == "lru") { policy = CACHE_LRU; return true; }
+  if (name == "2q") { policy = CACHE_2Q; return true; }
+  if (name == "cost") { policy = CACHE_COST; return true; }
+  return false;
+}
+
+/**
+ * @brief Create a policy
+ */
+std::unique_ptr<EvictionPolicy> EvictionPolicy::create(CachePolicy policy, size_t capacity, const std::vector<float>* scores) {
+  switch (policy) {
+    case CACHE_2Q: return std::make_unique<TwoQueuePolicy>(capacity);
+    case CACHE_COST: return std::make_unique<CostPolicy>(scores);
+    default: return std::make_unique<LRUPolicy>();
+  }
+}
+
+// ---- RecencyList ----
+
+void RecencyList::pushBack(int blockID) {
+  if (contains(blockID)) {
+    moveToBack(blockID);
+    return;
+  }
+  order.push_back(blockID);
+  where[blockID] = std::prev(order.end());
+}
+
+void RecencyList::moveToBack(int blockID) {
+  auto it = where.find(blockID);
+  if (it == where.end()) return;
+  // Move that node to the end in O(1)
+  order.splice(order.end(), order, it->second);
+}
+
+bool RecencyList::erase(int blockID) {
+  auto it = where.find(blockID);
+  if (it == where.end()) return false;
+  order.erase(it->second);
+  where.erase(it);
+  return true;
+}
+
+int RecencyList::popFront() {
+  if (order.empty()) return -1;
+  int blockID = order.front();
+  where.erase(blockID);
+  order.pop_front();
+  return blockID;
+}
+
+// ---- 2Q ----
+
+TwoQueuePolicy::TwoQueuePolicy(size_t capacity)
+  : kin(std::max<size_t>(1, capacity / 4)), kout(std::max<size_t>(1, capacity / 2)) {}
+
+/**
+ * @brief New blocks go to a1in, blocks remembered in a1out straight to am
+ */
+void TwoQueuePolicy::insert(int blockID) {
+  if (am.contains(blockID) || a1in.contains(blockID)) {
+    touch(blockID);
+    return;
+  }
+  if (a1out.erase(blockID)) {
+    am.pushBack(blockID);
+  } else {
+    a1in.pushBack(blockID);
+  }
+}
+
+/**
+ * @brief A hit in am refreshes its recency, a hit in a1in does not (FIFO)
+ */
+void TwoQueuePolicy::touch(int blockID) {
+  am.moveToBack(blockID);
+}
+
+/**
+ * @brief Blocks evicted from a1in and blocks taken back into a slot are remembered
+ *
+ * A block that goes back to a slot will likely be cached again when the
+ * slot is handed over, so it then goes to am directly.
+ */
+void TwoQueuePolicy::erase(int blockID, bool hit) {
+  bool wasNew = a1in.erase(blockID);
+  am.erase(blockID);
+  if (hit || wasNew) remember(blockID);
+}
+
+int TwoQueuePolicy::victim() const {
+  if (a1in.size() > kin || am.size() == 0) return a1in.size() > 0 ? a1in.front() : am.front();
+  return am.front();
+}
+
+void TwoQueuePolicy::clear() {
+  a1in.clear();
+  am.clear();
+  a1out.clear();
+}
+
+void TwoQueuePolicy::remember(int blockID) {
+  a1out.pushBack(blockID);
+  while (a1out.size() > kout) a1out.popFront();
+}
+
+// ---- cost-aware ----
+
+/**
+ * @brief Cached block with the lowest keep score, the oldest one on ties
+ */
+int CostPolicy::victim() const {
+  int best = -1;
+  float bestScore = std::numeric_limits<float>::max();
+  for (int blockID : entries.items()) {
+    float s = (scores && blockID < (int)scores->size()) ? (*scores)[blockID] : 0.0f;
+    if (s < bestScore) {
+      bestScore = s;
+      best = blockID;
+    }
+  }
+  return best;
+}
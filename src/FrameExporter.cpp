@@ -0,0 +1,183 @@
+//=============================================================================
+//
+//   FrameExporter - Asynchronous frame capture with PBO readback
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "FrameExporter.h"
+#include <stb_image_write.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+/**
+ * @brief Name of an export format, as on the command line
+ */
+const char* exportFormatName(ExportFormat format) {
+  return format == EXPORT_RAW ? "raw" : "png";
+}
+
+/**
+ * @brief Parse png|raw
+ */
+bool parseExportFormat(const std::string& name, ExportFormat& format) {
+  if (name == "png") { format = EXPORT_PNG; return true; }
+  if (name == "raw") { format = EXPORT_RAW; return true; }
+  return false;
+}
+
+/**
+ * @brief Create the pixel pack buffers and start the writers
+ */
+bool FrameExporter::init(int width_, int height_, const std::filesystem::path& dir_, ExportFormat format_, int numWriters, GLenum readBuffer_) {
+  width = std::max(1, width_);
+  height = std::max(1, height_);
+  dir = dir_;
+  format = format_;
+  readBuffer = readBuffer_;
+
+  std::error_code ec;
+  std::filesystem::create_directories(dir, ec);
+  if (ec) {
+    std::cerr << "Error: Could not create export directory " << dir << ": " << ec.message() << std::endl;
+    return false;
+  }
+
+  size_t bytes = (size_t)width * height * 4;
+  glGenBuffers(EXPORT_PBOS, pbos);
+  for (int i = 0; i < EXPORT_PBOS; i++) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+    glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)bytes, nullptr, GL_STREAM_READ);
+    fences[i] = nullptr;
+    pboFrame[i] = -1;
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  next = 0;
+  queued = 0;
+
+  numWriters = std::max(1, numWriters);
+  for (int i = 0; i < numWriters * EXPORT_IMAGES_PER_WRITER; i++) {
+    Image img;
+    img.rgba.resize(bytes);
+    freeQ.push(std::move(img));
+  }
+  writers.reserve(numWriters);
+  for (int i = 0; i < numWriters; i++) writers.emplace_back(&FrameExporter::writerMain, this);
+  return true;
+}
+
+/**
+ * @brief Read the frame into the next PBO
+ *
+ * The PBO still holds the readback of EXPORT_PBOS captures ago, which goes
+ * to the writers first. With a pack buffer bound glReadPixels returns as
+ * soon as the copy is queued.
+ */
+void FrameExporter::capture(int frameIndex) {
+  if (pbos[0] == 0) return;
+  if (pboFrame[next] >= 0) retire(next);
+
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadBuffer(readBuffer); // capture what you're about to swap
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[next]);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  fences[next] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  pboFrame[next] = frameIndex;
+  next = (next + 1) % EXPORT_PBOS;
+}
+
+/**
+ * @brief Map PBO i, copy it flipped into a free image and queue it
+ */
+void FrameExporter::retire(int i) {
+  // frames later the fence has passed, this only waits if the GPU is far behind
+  if (fences[i] != nullptr) {
+    glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    glDeleteSync(fences[i]);
+    fences[i] = nullptr;
+  }
+
+  Image img;
+  freeQ.pop(img); // waits if the writers fall behind
+
+  size_t row = (size_t)width * 4;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+  const unsigned char* src = static_cast<const unsigned char*>(
+    glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)(row * height), GL_MAP_READ_BIT));
+  if (src != nullptr) {
+    // OpenGL origin is bottom-left, so the last row read is the top row
+    for (int y = 0; y < height; y++) {
+      std::memcpy(img.rgba.data() + (size_t)y * row, src + (size_t)(height - 1 - y) * row, row);
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  if (src == nullptr) {
+    std::cerr << "Error: Could not map the readback of frame " << pboFrame[i] << std::endl;
+    freeQ.push(std::move(img));
+  } else {
+    img.frameIndex = pboFrame[i];
+    filledQ.push(std::move(img));
+    queued++;
+  }
+  pboFrame[i] = -1;
+}
+
+/**
+ * @brief Encode and write images until stopped
+ */
+void FrameExporter::writerMain() {
+  Image img;
+  while (filledQ.pop(img)) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "frame_%05d.%s", img.frameIndex, format == EXPORT_RAW ? "rgba" : "png");
+    std::string path = (dir / name).string();
+
+    bool ok;
+    if (format == EXPORT_RAW) {
+      std::ofstream out(path, std::ios::binary);
+      out.write(reinterpret_cast<const char*>(img.rgba.data()), (std::streamsize)img.rgba.size());
+      ok = (bool)out;
+    } else {
+      ok = stbi_write_png(path.c_str(), width, height, 4, img.rgba.data(), width * 4) != 0;
+    }
+    if (!ok) std::cerr << "Error: Could not write " << path << std::endl;
+
+    freeQ.push(std::move(img));
+  }
+}
+
+/**
+ * @brief Hand all pending readbacks to the writers and wait until everything is written
+ */
+void FrameExporter::finish() {
+  if (pbos[0] != 0) {
+    // oldest first, next points at the oldest readback
+    for (int k = 0; k < EXPORT_PBOS; k++) {
+      int i = (next + k) % EXPORT_PBOS;
+      if (pboFrame[i] >= 0) retire(i);
+    }
+  }
+  filledQ.stop();
+  for (std::thread& t : writers) t.join();
+  writers.clear();
+}
+
+/**
+ * @brief finish(), then delete the buffers, needs the context
+ */
+void FrameExporter::destroy() {
+  finish();
+  if (pbos[0] != 0) glDeleteBuffers(EXPORT_PBOS, pbos);
+  for (int i = 0; i < EXPORT_PBOS; i++) {
+    pbos[i] = 0;
+    if (fences[i] != nullptr) glDeleteSync(fences[i]);
+    fences[i] = nullptr;
+  }
+}
@@ -0,0 +1,188 @@
+//=============================================================================
+//
+//   FrustumCuller - Batched world space frustum culling of block bounds
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <thread>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// ---- lanes of the target instruction set ----
+namespace {
+#if defined(__AVX__)
+typedef __m256 vfloat;
+constexpr int LANES = 8;
+inline vfloat vload(const float* p) { return _mm256_loadu_ps(p); }
+inline void vstore(float* p, vfloat v) { _mm256_storeu_ps(p, v); }
+inline vfloat vset(float x) { return _mm256_set1_ps(x); }
+inline vfloat vadd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+inline vfloat vsub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+inline vfloat vmul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+inline vfloat vmin(vfloat a, vfloat b) { return _mm256_min_ps(a, b); }
+inline vfloat vsqrt(vfloat a) { return _mm256_sqrt_ps(a); }
+#elif defined(__SSE2__)
+typedef __m128 vfloat;
+constexpr int LANES = 4;
+inline vfloat vload(const float* p) { return _mm_loadu_ps(p); }
+inline void vstore(float* p, vfloat v) { _mm_storeu_ps(p, v); }
+inline vfloat vset(float x) { return _mm_set1_ps(x); }
+inline vfloat vadd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+inline vfloat vsub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+inline vfloat vmul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+inline vfloat vmin(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+inline vfloat vsqrt(vfloat a) { return _mm_sqrt_ps(a); }
+#else
+typedef float vfloat;
+constexpr int LANES = 1;
+inline vfloat vload(const float* p) { return *p; }
+inline void vstore(float* p, vfloat v) { *p = v; }
+inline vfloat vset(float x) { return x; }
+inline vfloat vadd(vfloat a, vfloat b) { return a + b; }
+inline vfloat vsub(vfloat a, vfloat b) { return a - b; }
+inline vfloat vmul(vfloat a, vfloat b) { return a * b; }
+inline vfloat vmin(vfloat a, vfloat b) { return std::min(a, b); }
+inline vfloat vsqrt(vfloat a) { return std::sqrt(a); }
+#endif
+static_assert(CULL_WIDTH % LANES == 0, "CULL_WIDTH must be a multiple of the SIMD width");
+
+/** @brief Distance of the block centers to a point */
+inline vfloat centerDistance(vfloat cx, vfloat cy, vfloat cz, const glm::vec3& p) {
+  vfloat dx = vsub(cx, vset(p.x));
+  vfloat dy = vsub(cy, vset(p.y));
+  vfloat dz = vsub(cz, vset(p.z));
+  return vsqrt(vadd(vadd(vmul(dx, dx), vmul(dy, dy)), vmul(dz, dz)));
+}
+} // namespace
+
+/**
+ * @brief Copy the bounds of the blocks
+ */
+void FrustumCuller::init(const std::vector<Block>& blocks, int numThreads_) {
+  size_t n = blocks.size();
+  size_t padded = (n + CULL_WIDTH - 1) / CULL_WIDTH * CULL_WIDTH;
+  for (std::vector<float>* a : { &minX, &minY, &minZ, &maxX, &maxY, &maxZ }) {
+    a->assign(padded, 0.0f);
+  }
+  ids.resize(n);
+  maxBlockID = -1;
+  for (size_t i = 0; i < n; i++) {
+    const Block& b = blocks[i];
+    minX[i] = b.bb_min.x; minY[i] = b.bb_min.y; minZ[i] = b.bb_min.z;
+    maxX[i] = b.bb_max.x; maxY[i] = b.bb_max.y; maxZ[i] = b.bb_max.z;
+    ids[i] = b.blockID;
+    maxBlockID = std::max(maxBlockID, b.blockID);
+  }
+  numThreads = std::max(1, numThreads_);
+}
+
+/**
+ * @brief World space frustum planes of proj * view
+ *
+ * Same extraction as on the projection alone, but on the combined matrix
+ * the planes come out in world space, so the boxes are tested as they are.
+ */
+std::array<Plane, 6> FrustumCuller::extractPlanes(const glm::mat4& viewProj) {
+  // GLM matrices are column-major. Transpose to treat m[i] as row i.
+  glm::mat4 m = glm::transpose(viewProj);
+  return {
+    normalizePlane(m[3] + m[0]), // Left
+    normalizePlane(m[3] - m[0]), // Right
+    normalizePlane(m[3] + m[1]), // Bottom
+    normalizePlane(m[3] - m[1]), // Top
+    normalizePlane(m[3] + m[2]), // Near
+    normalizePlane(m[3] - m[2])  // Far
+  };
+}
+
+/**
+ * @brief Test all blocks against the frustum of a camera
+ *
+ * The view is rigid, so world space distances are the view space distances
+ * the renderer used before: the camera sits at the origin of view space and
+ * the frustum center at z = -(near + far) / 2.
+ */
+void FrustumCuller::cull(const glm::mat4& proj, const glm::mat4& view, float zNear, float zFar, CullOutput& out) const {
+  size_t slots = (size_t)(maxBlockID + 1);
+  out.planeDist.resize(slots);
+  out.cameraDist.resize(slots);
+  out.frustumCenterDist.resize(slots);
+  if (ids.empty()) return;
+
+  std::array<Plane, 6> planes = extractPlanes(proj * view);
+  glm::mat4 inv = glm::inverse(view);
+  glm::vec3 eye = glm::vec3(inv[3]);
+  glm::vec3 forward = -glm::normalize(glm::vec3(inv[2]));
+  glm::vec3 center = eye + 0.5f * (zNear + zFar) * forward;
+
+  size_t batches = minX.size() / CULL_WIDTH;
+  size_t chunks = std::min<size_t>((size_t)numThreads, ids.size() / CULL_PARALLEL_MIN);
+  if (chunks <= 1) {
+    cullRange(planes, eye, center, 0, minX.size(), out);
+    return;
+  }
+
+  // whole batches per thread, the calling thread takes the last chunk
+  std::vector<std::thread> threads;
+  size_t per = (batches + chunks - 1) / chunks;
+  for (size_t c = 0; c + 1 < chunks; c++) {
+    size_t begin = c * per * CULL_WIDTH;
+    size_t end = std::min(batches, (c + 1) * per) * CULL_WIDTH;
+    threads.emplace_back([&, begin, end]() { cullRange(planes, eye, center, begin, end, out); });
+  }
+  cullRange(planes, eye, center, std::min(batches, (chunks - 1) * per) * CULL_WIDTH, minX.size(), out);
+  for (std::thread& t : threads) t.join();
+}
+
+/**
+ * @brief Cull the padded batch range [begin, end)
+ *
+ * Per plane the positive vertex (the corner that maximizes dot(n, x)) picks
+ * the min or max array of each axis once for the whole batch.
+ */
+void FrustumCuller::cullRange(const std::array<Plane, 6>& planes, const glm::vec3& eye, const glm::vec3& center,
+                              size_t begin, size_t end, CullOutput& out) const {
+  float dist[CULL_WIDTH], camDist[CULL_WIDTH], centerDist[CULL_WIDTH];
+
+  for (size_t i = begin; i < end; i += CULL_WIDTH) {
+    for (int l = 0; l < CULL_WIDTH; l += LANES) {
+      size_t j = i + l;
+      vfloat best = vset(FLT_MAX);
+      for (const Plane& plane : planes) {
+        vfloat px = vload(&(plane.n.x >= 0.0f ? maxX : minX)[j]);
+        vfloat py = vload(&(plane.n.y >= 0.0f ? maxY : minY)[j]);
+        vfloat pz = vload(&(plane.n.z >= 0.0f ? maxZ : minZ)[j]);
+        vfloat d = vadd(vadd(vmul(vset(plane.n.x), px), vmul(vset(plane.n.y), py)),
+                        vadd(vmul(vset(plane.n.z), pz), vset(plane.d)));
+        best = vmin(best, d);
+      }
+      vstore(dist + l, best);
+
+      vfloat half = vset(0.5f);
+      vfloat cx = vmul(half, vadd(vload(&minX[j]), vload(&maxX[j])));
+      vfloat cy = vmul(half, vadd(vload(&minY[j]), vload(&maxY[j])));
+      vfloat cz = vmul(half, vadd(vload(&minZ[j]), vload(&maxZ[j])));
+      vstore(camDist + l, centerDistance(cx, cy, cz, eye));
+      vstore(centerDist + l, centerDistance(cx, cy, cz, center));
+    }
+
+    // scatter to blockIDs, the padding has none
+    size_t n = std::min<size_t>(CULL_WIDTH, ids.size() > i ? ids.size() - i : 0);
+    for (size_t k = 0; k < n; k++) {
+      int id = ids[i + k];
+      out.planeDist[id] = dist[k];
+      out.cameraDist[id] = camDist[k];
+      out.frustumCenterDist[id] = centerDist[k];
+    }
+  }
+}
@@ -0,0 +1,78 @@
+//=============================================================================
+//
+//   GLExt - OpenGL entry points and capabilities beyond the GL 3.3 glad loader
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "GLExt.h"
+#include <cstring>
+
+PFNGLBUFFERSTORAGEPROC glext_glBufferStorage = nullptr;
+PFNGLMULTIDRAWARRAYSINDIRECTPROC glext_glMultiDrawArraysIndirect = nullptr;
+PFNGLDISPATCHCOMPUTEPROC glext_glDispatchCompute = nullptr;
+PFNGLMEMORYBARRIERPROC glext_glMemoryBarrier = nullptr;
+PFNGLCLEARBUFFERDATAPROC glext_glClearBufferData = nullptr;
+
+GLCaps glCaps;
+
+/**
+ * @brief Check if the current context exposes an extension
+ */
+bool hasGLExtension(const char* name) {
+  GLint n = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &n);
+  for (GLint i = 0; i < n; ++i) {
+    const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, (GLuint)i));
+    if (ext != nullptr && std::strcmp(ext, name) == 0) return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Load entry points that glad (GL 3.3 core) does not cover and fill glCaps
+ */
+bool loadGLExtensions(GLADloadproc load) {
+  glGetIntegerv(GL_MAJOR_VERSION, &glCaps.major);
+  glGetIntegerv(GL_MINOR_VERSION, &glCaps.minor);
+  auto atLeast = [](int major, int minor) {
+    return glCaps.major > major || (glCaps.major == major && glCaps.minor >= minor);
+  };
+
+  if (atLeast(4, 4) || hasGLExtension("GL_ARB_buffer_storage")) {
+    glext_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+    glCaps.bufferStorage = (glext_glBufferStorage != nullptr);
+  }
+  if (atLeast(4, 3) || hasGLExtension("GL_ARB_multi_draw_indirect")) {
+    glext_glMultiDrawArraysIndirect = (PFNGLMULTIDRAWARRAYSINDIRECTPROC)load("glMultiDrawArraysIndirect");
+    glCaps.multiDrawIndirect = (glext_glMultiDrawArraysIndirect != nullptr);
+  }
+  if (atLeast(4, 3)) {
+    glext_glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
+    glext_glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)load("glMemoryBarrier");
+    glext_glClearBufferData = (PFNGLCLEARBUFFERDATAPROC)load("glClearBufferData");
+    glCaps.compute = glext_glDispatchCompute && glext_glMemoryBarrier && glext_glClearBufferData;
+    glCaps.atomic64 = glCaps.compute && hasGLExtension("GL_ARB_gpu_shader_int64") && hasGLExtension("GL_NV_shader_atomic_int64");
+  }
+  glCaps.memInfoNVX = hasGLExtension("GL_NVX_gpu_memory_info");
+  glCaps.memInfoATI = hasGLExtension("GL_ATI_meminfo");
+  return true;
+}
+
+/**
+ * @brief Free video memory in bytes, false if the driver does not report it
+ */
+bool queryFreeVRAM(uint64_t& bytes) {
+  GLint kb[4] = {0, 0, 0, 0}; // ATI: total free, largest block, total aux free, largest aux block
+  if (glCaps.memInfoNVX) {
+    glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, kb);
+  } else if (glCaps.memInfoATI) {
+    glGetIntegerv(GL_VBO_FREE_MEMORY_ATI, kb);
+  } else {
+    return false;
+  }
+  if (kb[0] <= 0) return false;
+  bytes = (uint64_t)kb[0] * 1024;
+  return true;
+}
@@ -0,0 +1,107 @@
+//=============================================================================
+//
+//   JobScheduler - Thread-safe priority queue of block loading jobs
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "JobScheduler.h"
+#include <algorithm>
+
+/**
+ * @brief Heap order: lower priority value first, older generation breaks ties
+ */
+bool JobScheduler::later(const Job& a, const Job& b) {
+  if (a.priority != b.priority) return a.priority > b.priority;
+  return a.generation > b.generation;
+}
+
+/**
+ * @brief Push a job and wake up one waiting worker
+ */
+void JobScheduler::push(Job job) {
+  {
+    std::lock_guard<std::mutex> lk(m_);
+    heap_.push_back(std::move(job));
+    std::push_heap(heap_.begin(), heap_.end(), later);
+  }
+  cv_.notify_one();
+}
+
+/**
+ * @brief Pop the most urgent job, blocking while empty
+ * @return false once stop() was called and nothing is left
+ */
+bool JobScheduler::pop(Job& out) {
+  std::unique_lock<std::mutex> lk(m_);
+  cv_.wait(lk, [&] { return stop_ || !heap_.empty(); });
+  if (stop_ && heap_.empty()) return false;
+
+  std::pop_heap(heap_.begin(), heap_.end(), later);
+  out = std::move(heap_.back());
+  heap_.pop_back();
+  return true;
+}
+
+/**
+ * @brief Pop up to max jobs in priority order, blocking until there is one
+ *
+ * Only waits for the first job, the rest is whatever is queued already.
+ * @return false once stop() was called and nothing is left
+ */
+bool JobScheduler::popBatch(std::vector<Job>& out, size_t max) {
+  out.clear();
+  std::unique_lock<std::mutex> lk(m_);
+  cv_.wait(lk, [&] { return stop_ || !heap_.empty(); });
+  if (stop_ && heap_.empty()) return false;
+
+  while (!heap_.empty() && out.size() < max) {
+    std::pop_heap(heap_.begin(), heap_.end(), later);
+    out.push_back(std::move(heap_.back()));
+    heap_.pop_back();
+  }
+  return true;
+}
+
+/**
+ * @brief Re-key queued jobs and drop the ones below minGeneration
+ *
+ * One lock for the whole pass; the heap is rebuilt once at the end.
+ */
+void JobScheduler::reschedule(const std::function<void(Job&)>& refresh, uint32_t minGeneration, std::vector<Job>& dropped) {
+  std::lock_guard<std::mutex> lk(m_);
+  if (heap_.empty()) return;
+
+  size_t k = 0;
+  for (size_t i = 0; i < heap_.size(); i++) {
+    refresh(heap_[i]);
+    if (heap_[i].generation < minGeneration) {
+      dropped.push_back(std::move(heap_[i]));
+    } else {
+      if (k != i) heap_[k] = std::move(heap_[i]);
+      k++;
+    }
+  }
+  heap_.resize(k);
+  std::make_heap(heap_.begin(), heap_.end(), later);
+}
+
+/**
+ * @brief Number of queued jobs
+ */
+size_t JobScheduler::size() {
+  std::lock_guard<std::mutex> lk(m_);
+  return heap_.size();
+}
+
+/**
+ * @brief Signal all workers to stop waiting and exit
+ */
+void JobScheduler::stop() {
+  {
+    std::lock_guard<std::mutex> lk(m_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+}
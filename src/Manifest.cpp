@@ -0,0 +1,200 @@
+//=============================================================================
+//
+//   Manifest - Versioned index of the on-disk block store
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "Manifest.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <system_error>
+
+namespace {
+
+constexpr char MAGIC[4] = {'M', 'R', 'B', 'S'};
+constexpr uint64_t FNV_OFFSET = 1469598103934665603ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+constexpr size_t HASH_SAMPLES = 16;
+constexpr size_t HASH_SAMPLE_BYTES = 1u << 16;
+
+void fnv1a(uint64_t& h, const unsigned char* data, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    h ^= data[i];
+    h *= FNV_PRIME;
+  }
+}
+
+template <class T>
+void put(std::ofstream& os, const T& v) {
+  os.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <class T>
+bool get(std::ifstream& is, T& v) {
+  is.read(reinterpret_cast<char*>(&v), sizeof(T));
+  return (size_t)is.gcount() == sizeof(T);
+}
+
+} // namespace
+
+/**
+ * @brief Cheap content hash of a file
+ *
+ * Hashing the whole PLY would cost as much as the bbox pass we want to skip,
+ * so only the size, the first chunk (the header) and a few evenly spaced
+ * chunks are hashed. Together with size and mtime this catches replaced files.
+ */
+uint64_t hashFileSampled(const std::filesystem::path& path) {
+  std::ifstream is(path, std::ios::binary);
+  if (!is.is_open()) return 0;
+
+  std::error_code ec;
+  uint64_t size = std::filesystem::file_size(path, ec);
+  if (ec) return 0;
+
+  uint64_t h = FNV_OFFSET;
+  fnv1a(h, reinterpret_cast<const unsigned char*>(&size), sizeof(size));
+
+  std::vector<unsigned char> buf(HASH_SAMPLE_BYTES);
+  for (size_t i = 0; i < HASH_SAMPLES; ++i) {
+    uint64_t offset = (size > HASH_SAMPLE_BYTES) ? (size - HASH_SAMPLE_BYTES) / (HASH_SAMPLES - 1) * i : 0;
+    is.clear();
+    is.seekg((std::streamoff)offset);
+    is.read(reinterpret_cast<char*>(buf.data()), (std::streamsize)buf.size());
+    fnv1a(h, buf.data(), (size_t)is.gcount());
+  }
+  return h;
+}
+
+/**
+ * @brief Fill version, source identity and partition settings for the given PLY file
+ */
+bool Manifest::describeSource(const std::filesystem::path& plyPath, const PartitionConfig& partition) {
+  std::error_code ec;
+  version = MANIFEST_VERSION;
+  sourceSize = std::filesystem::file_size(plyPath, ec);
+  if (ec) {
+    std::cerr << "Error: Could not stat PLY file: " << plyPath << std::endl;
+    return false;
+  }
+  auto mtime = std::filesystem::last_write_time(plyPath, ec);
+  if (ec) {
+    std::cerr << "Error: Could not stat PLY file: " << plyPath << std::endl;
+    return false;
+  }
+  sourceMtime = (int64_t)mtime.time_since_epoch().count();
+  sourceHash = hashFileSampled(plyPath);
+  // only the settings of the active mode take part in the identity
+  partitionMode = (int32_t)partition.mode;
+  grid = (partition.mode == PARTITION_GRID) ? partition.grid : 0;
+  maxBlockPoints = (partition.mode == PARTITION_KD) ? partition.maxBlockPoints : 0;
+  compression = (int32_t)partition.compression;
+  return true;
+}
+
+/**
+ * @brief Check if this manifest was built from the same source and settings
+ */
+bool Manifest::matches(const Manifest& other) const {
+  return version == other.version &&
+         sourceSize == other.sourceSize &&
+         sourceMtime == other.sourceMtime &&
+         sourceHash == other.sourceHash &&
+         partitionMode == other.partitionMode &&
+         grid == other.grid &&
+         maxBlockPoints == other.maxBlockPoints &&
+         compression == other.compression;
+}
+
+/**
+ * @brief Write manifest to disk
+ *
+ * Goes through a temporary file and a rename, so an interrupted run never
+ * leaves a manifest that points at half-written block files.
+ */
+bool Manifest::write(const std::filesystem::path& path) const {
+  std::filesystem::path tmp = path;
+  tmp += ".tmp";
+  {
+    std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+    if (!os.is_open()) {
+      std::cerr << "Error: Could not write manifest: " << tmp << std::endl;
+      return false;
+    }
+    os.write(MAGIC, sizeof(MAGIC));
+    put(os, version);
+    put(os, sourceSize);
+    put(os, sourceMtime);
+    put(os, sourceHash);
+    put(os, partitionMode);
+    put(os, grid);
+    put(os, maxBlockPoints);
+    put(os, compression);
+    put(os, vertexCount);
+    put(os, bb_min);
+    put(os, bb_max);
+    uint64_t n = blocks.size();
+    put(os, n);
+    for (const auto& b : blocks) {
+      put(os, b.count);
+      put(os, b.offset);
+      put(os, b.bytes);
+      put(os, b.bb_min);
+      put(os, b.bb_max);
+      uint32_t nc = (uint32_t)b.chunks.size();
+      put(os, nc);
+      os.write(reinterpret_cast<const char*>(b.chunks.data()), (std::streamsize)(nc * sizeof(uint32_t)));
+    }
+    if (!os.good()) {
+      std::cerr << "Error: Failed to write manifest: " << tmp << std::endl;
+      return false;
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  if (ec) {
+    std::cerr << "Error: Could not move manifest into place: " << path << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Read manifest from disk
+ */
+bool Manifest::read(const std::filesystem::path& path) {
+  std::ifstream is(path, std::ios::binary);
+  if (!is.is_open()) return false;
+
+  char magic[4];
+  is.read(magic, sizeof(magic));
+  if (is.gcount() != sizeof(magic) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+  if (!get(is, version) || version != MANIFEST_VERSION) return false;
+
+  uint64_t n = 0;
+  if (!get(is, sourceSize) || !get(is, sourceMtime) || !get(is, sourceHash) ||
+      !get(is, partitionMode) || !get(is, grid) || !get(is, maxBlockPoints) || !get(is, compression) || !get(is, vertexCount) || !get(is, bb_min) || !get(is, bb_max) ||
+      !get(is, n)) {
+    return false;
+  }
+  // a corrupt count must not allocate: every record takes at least its fixed fields
+  constexpr uint64_t MIN_RECORD = sizeof(int) + 2 * sizeof(uint64_t) + 2 * sizeof(glm::vec3) + sizeof(uint32_t);
+  std::error_code ec;
+  uint64_t fileSize = std::filesystem::file_size(path, ec);
+  std::streamoff pos = is.tellg();
+  if (ec || pos < 0 || n > (uint64_t)MAX_BLOCKS || n * MIN_RECORD > fileSize - (uint64_t)pos) return false;
+  blocks.resize(n);
+  for (auto& b : blocks) {
+    uint32_t nc = 0;
+    if (!get(is, b.count) || !get(is, b.offset) || !get(is, b.bytes) || !get(is, b.bb_min) || !get(is, b.bb_max) || !get(is, nc)) return false;
+    // a compressed block has one offset per chunk and the end, a raw block none
+    if (b.count < 0 || (nc != 0 && (compression == 0 || nc != chunkCount((size_t)b.count) + 1))) return false;
+    b.chunks.resize(nc);
+    is.read(reinterpret_cast<char*>(b.chunks.data()), (std::streamsize)(nc * sizeof(uint32_t)));
+    if ((size_t)is.gcount() != nc * sizeof(uint32_t)) return false;
+  }
+  return true;
+}
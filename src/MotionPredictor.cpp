@@ -0,0 +1,46 @@
+//=============================================================================
+//
+//   MotionPredictor - Extrapolates the camera pose from recent frames
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "MotionPredictor.h"
+#include <cmath>
+
+/**
+ * @brief Add the pose of this frame
+ */
+void MotionPredictor::observe(const Camera& camera) {
+  history.push_back({ camera.Position, camera.Yaw, camera.Pitch });
+  if (history.size() > PREDICT_HISTORY) history.pop_front();
+}
+
+/**
+ * @brief Camera extrapolated by the given number of frames
+ * @param camera current camera, its settings (axis, zoom) carry over
+ * @param frames how far to look ahead
+ * @param out predicted camera
+ */
+bool MotionPredictor::predict(const Camera& camera, float frames, Camera& out) const {
+  if (history.size() < 2) return false;
+
+  const Sample& a = history.front();
+  const Sample& b = history.back();
+  float n = (float)(history.size() - 1);
+
+  glm::vec3 velocity = (b.position - a.position) / n;
+  // shortest way around, yaw wraps at +-180
+  float dyaw = std::remainder(b.yaw - a.yaw, 360.0f) / n;
+  float dpitch = (b.pitch - a.pitch) / n;
+
+  if (glm::length(velocity) < PREDICT_MIN_SPEED &&
+      std::fabs(dyaw) < PREDICT_MIN_SPEED && std::fabs(dpitch) < PREDICT_MIN_SPEED) {
+    return false;
+  }
+
+  out = camera;
+  out.setPose(b.position + frames * velocity, b.yaw + frames * dyaw, b.pitch + frames * dpitch, camera.Zoom);
+  return true;
+}
@@ -0,0 +1,141 @@
+//=============================================================================
+//
+//   OcclusionCuller - Occlusion queries on block bounding boxes
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <iostream>
+#include <exception>
+
+/**
+ * @brief Create one query per block and the box shader
+ */
+bool OcclusionCuller::init(const std::vector<Block>& blocks, const char* vertPath, const char* fragPath, int minSamples_) {
+  try {
+    shader = new Shader(vertPath, fragPath);
+  } catch (const std::exception& e) {
+    std::cerr << "Failed to create the occlusion shader: " << e.what() << std::endl;
+    shader = nullptr;
+    return false;
+  }
+  GLint linked = GL_FALSE;
+  glGetProgramiv(shader->ID, GL_LINK_STATUS, &linked);
+  if (linked != GL_TRUE) {
+    std::cerr << "Error: Could not build the occlusion shader from " << vertPath << ", " << fragPath << std::endl;
+    return false;
+  }
+  locBoxMin = glGetUniformLocation(shader->ID, "BoxMin");
+  locBoxExtent = glGetUniformLocation(shader->ID, "BoxExtent");
+
+  // the box comes from gl_VertexID, core profile still wants a VAO bound
+  glGenVertexArrays(1, &vao);
+
+  int maxID = -1;
+  for (const Block& b : blocks) maxID = std::max(maxID, b.blockID);
+  queries.assign(maxID + 1, 0);
+  pending.assign(maxID + 1, 0);
+  occluded.assign(maxID + 1, 0);
+  for (const Block& b : blocks) glGenQueries(1, &queries[b.blockID]);
+  inFlight.clear();
+  inFlight.reserve(OCCLUSION_MAX_QUERIES * 4);
+  cursor = 0;
+  minSamples = (GLuint)std::max(1, minSamples_);
+  return true;
+}
+
+/**
+ * @brief Delete the GL objects, needs the context
+ */
+void OcclusionCuller::destroy() {
+  for (GLuint& q : queries) {
+    if (q != 0) glDeleteQueries(1, &q);
+    q = 0;
+  }
+  if (vao != 0) glDeleteVertexArrays(1, &vao);
+  vao = 0;
+  if (shader != nullptr) {
+    if (shader->ID != 0) glDeleteProgram(shader->ID);
+    delete shader;
+    shader = nullptr;
+  }
+}
+
+/**
+ * @brief Read the queries that finished, never waits
+ */
+void OcclusionCuller::collect() {
+  size_t k = 0;
+  for (int id : inFlight) {
+    GLuint available = 0;
+    glGetQueryObjectuiv(queries[id], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+      inFlight[k++] = id; // still on the GPU, try next frame
+      continue;
+    }
+    GLuint samples = 0;
+    glGetQueryObjectuiv(queries[id], GL_QUERY_RESULT, &samples);
+    occluded[id] = (samples < minSamples);
+    pending[id] = 0;
+  }
+  inFlight.resize(k);
+}
+
+/**
+ * @brief Query the boxes of the blocks in the frustum against the depth of this frame
+ *
+ * At most OCCLUSION_MAX_QUERIES boxes per frame, continuing where the last
+ * frame stopped. Blocks that left the frustum forget their result, so they
+ * come back as visible.
+ */
+void OcclusionCuller::issue(const std::vector<Block>& blocks, const CullOutput& cull,
+                            const glm::mat4& view, const glm::mat4& proj, const glm::vec3& eye, float zNear) {
+  if (shader == nullptr || blocks.empty()) return;
+
+  shader->use();
+  shader->setMat4("View", view);
+  shader->setMat4("Proj", proj);
+  glBindVertexArray(vao);
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  glDepthMask(GL_FALSE);
+
+  size_t n = blocks.size();
+  int issued = 0;
+  size_t next = cursor;
+  for (size_t k = 0; k < n; k++) {
+    size_t i = (cursor + k) % n;
+    const Block& b = blocks[i];
+    int id = b.blockID;
+    if (cull.planeDist[id] < 0.0f) {
+      occluded[id] = 0;
+      continue;
+    }
+    // box clipped by the near plane, it would have no samples to count
+    glm::vec3 lo = b.bb_min - glm::vec3(zNear);
+    glm::vec3 hi = b.bb_max + glm::vec3(zNear);
+    if (eye.x >= lo.x && eye.y >= lo.y && eye.z >= lo.z && eye.x <= hi.x && eye.y <= hi.y && eye.z <= hi.z) {
+      occluded[id] = 0;
+      continue;
+    }
+    if (pending[id] || issued >= OCCLUSION_MAX_QUERIES) continue;
+
+    glUniform3fv(locBoxMin, 1, &b.bb_min[0]);
+    glm::vec3 extent = b.bb_max - b.bb_min;
+    glUniform3fv(locBoxExtent, 1, &extent[0]);
+    glBeginQuery(GL_SAMPLES_PASSED, queries[id]);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 14);
+    glEndQuery(GL_SAMPLES_PASSED);
+    pending[id] = 1;
+    inFlight.push_back(id);
+    issued++;
+    next = i + 1;
+  }
+  cursor = next % n;
+
+  glDepthMask(GL_TRUE);
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  glBindVertexArray(0);
+}
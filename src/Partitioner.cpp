@@ -0,0 +1,138 @@
+//=============================================================================
+//
+//   Partitioner - Spatial subdivision of the point cloud into blocks
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "Partitioner.h"
+#include "Utils.h"
+#include <algorithm>
+#include <iostream>
+
+/**
+ * @brief Build the partition
+ * @param config_ partitioning settings
+ * @param bb_min, bb_max global bbox (estimate)
+ * @param samples sample positions of the point cloud (k-d only), reordered in place
+ * @param vertexCount number of points the samples stand for
+ */
+bool Partitioner::build(const PartitionConfig& config_, const glm::vec3& bb_min, const glm::vec3& bb_max,
+                        std::vector<glm::vec3>& samples, uint64_t vertexCount)
+{
+  config = config_;
+  nodes.clear();
+  cellMin.clear();
+  cellMax.clear();
+
+  if (config.mode == PARTITION_GRID) {
+    int g = config.grid;
+    if (g < 1 || (uint64_t)g * g * g > (uint64_t)MAX_BLOCKS) {
+      std::cerr << "Error: Grid size " << g << " gives more than " << MAX_BLOCKS << " blocks." << std::endl;
+      return false;
+    }
+    glm::vec3 cell = (bb_max - bb_min) / (float)g;
+    frameMin = bb_min;
+    invCell = glm::vec3(cell.x > 0.0f ? 1.0f / cell.x : 0.0f,
+                        cell.y > 0.0f ? 1.0f / cell.y : 0.0f,
+                        cell.z > 0.0f ? 1.0f / cell.z : 0.0f);
+    cellMin.resize((size_t)g * g * g);
+    cellMax.resize((size_t)g * g * g);
+    for (int z = 0; z < g; ++z) {
+      for (int y = 0; y < g; ++y) {
+        for (int x = 0; x < g; ++x) {
+          int id = x + g * y + g * g * z;
+          cellMin[id] = bb_min + glm::vec3(x, y, z) * cell;
+          cellMax[id] = bb_min + glm::vec3(x + 1, y + 1, z + 1) * cell;
+        }
+      }
+    }
+    return true;
+  }
+
+  // k-d: keep the number of leaves (at most ~2x the ideal count) within MAX_BLOCKS
+  uint64_t maxPoints = std::max<uint64_t>(config.maxBlockPoints, 1);
+  maxPoints = std::max<uint64_t>(maxPoints, 2 * vertexCount / MAX_BLOCKS + 1);
+  if (maxPoints != config.maxBlockPoints) {
+    std::cout << "Raised max points per block to " << maxPoints << " to stay within " << MAX_BLOCKS << " blocks." << std::endl;
+  }
+
+  if (samples.empty() || vertexCount == 0) {
+    // nothing to split on, one block
+    cellMin.push_back(bb_min);
+    cellMax.push_back(bb_max);
+    nodes.emplace_back();
+    nodes[0].left = 0;
+    return true;
+  }
+
+  // each sample stands for vertexCount / samples.size() points
+  uint64_t maxSamples = maxPoints * (uint64_t)samples.size() / vertexCount;
+  maxSamples = std::max<uint64_t>(maxSamples, KD_MIN_SAMPLES);
+  buildNode(samples, 0, samples.size(), bb_min, bb_max, maxSamples);
+  return true;
+}
+
+/**
+ * @brief Split samples [first, last) of a node recursively
+ *
+ * The longest axis of the node is split at the median sample, so both
+ * halves get the same estimated number of points.
+ */
+int Partitioner::buildNode(std::vector<glm::vec3>& samples, size_t first, size_t last,
+                           const glm::vec3& mn, const glm::vec3& mx, uint64_t maxSamples)
+{
+  int idx = (int)nodes.size();
+  nodes.emplace_back();
+
+  glm::vec3 extent = mx - mn;
+  int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+  size_t n = last - first;
+  if (n <= maxSamples || extent[axis] <= 0.0f || (int)cellMin.size() >= MAX_BLOCKS - 1) {
+    nodes[idx].left = (int)cellMin.size();
+    cellMin.push_back(mn);
+    cellMax.push_back(mx);
+    return idx;
+  }
+
+  size_t mid = first + n / 2;
+  std::nth_element(samples.begin() + first, samples.begin() + mid, samples.begin() + last,
+                   [axis](const glm::vec3& a, const glm::vec3& b) { return a[axis] < b[axis]; });
+  float split = samples[mid][axis];
+  // the samples lie in the node, this only guards against rounding
+  split = std::min(std::max(split, mn[axis]), mx[axis]);
+
+  glm::vec3 leftMax = mx;
+  glm::vec3 rightMin = mn;
+  leftMax[axis] = split;
+  rightMin[axis] = split;
+
+  int left = buildNode(samples, first, mid, mn, leftMax, maxSamples);
+  int right = buildNode(samples, mid, last, rightMin, mx, maxSamples);
+  nodes[idx].axis = axis;
+  nodes[idx].split = split;
+  nodes[idx].left = left;
+  nodes[idx].right = right;
+  return idx;
+}
+
+/**
+ * @brief Block id of a position
+ */
+int Partitioner::blockOf(const glm::vec3& p) const {
+  if (config.mode == PARTITION_GRID) {
+    int g = config.grid;
+    int ix = clampi((int)((p.x - frameMin.x) * invCell.x), 0, g - 1);
+    int iy = clampi((int)((p.y - frameMin.y) * invCell.y), 0, g - 1);
+    int iz = clampi((int)((p.z - frameMin.z) * invCell.z), 0, g - 1);
+    return ix + g * iy + g * g * iz;
+  }
+
+  int idx = 0;
+  while (nodes[idx].axis >= 0) {
+    const Node& node = nodes[idx];
+    idx = (p[node.axis] < node.split) ? node.left : node.right;
+  }
+  return nodes[idx].left;
+}
@@ -0,0 +1,410 @@
+//=============================================================================
+//
+//   PlyFormat - PLY header layout and vertex record decoders
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "PlyFormat.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <type_traits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Bytes of a scalar of the type
+ */
+size_t plyTypeSize(PlyType type) {
+  switch (type) {
+    case PLY_INT8: case PLY_UINT8: return 1;
+    case PLY_INT16: case PLY_UINT16: return 2;
+    case PLY_INT32: case PLY_UINT32: case PLY_FLOAT32: return 4;
+    default: return 8;
+  }
+}
+
+/**
+ * @brief Parse a PLY scalar type
+ */
+bool parsePlyType(const std::string& name, PlyType& type) {
+  if (name == "char" || name == "int8") { type = PLY_INT8; return true; }
+  if (name == "uchar" || name == "uint8") { type = PLY_UINT8; return true; }
+  if (name == "short" || name == "int16") { type = PLY_INT16; return true; }
+  if (name == "ushort" || name == "uint16") { type = PLY_UINT16; return true; }
+  if (name == "int" || name == "int32") { type = PLY_INT32; return true; }
+  if (name == "uint" || name == "uint32") { type = PLY_UINT32; return true; }
+  if (name == "float" || name == "float32") { type = PLY_FLOAT32; return true; }
+  if (name == "double" || name == "float64") { type = PLY_FLOAT64; return true; }
+  return false;
+}
+
+/**
+ * @brief Parse the header from the start of the file
+ *
+ * Elements in front of the vertices are skipped by their fixed record size,
+ * elements behind them are ignored.
+ */
+bool PlyLayout::read(std::istream& in) {
+  std::string line, word, format;
+  bool isPly = false, headerEnded = false, inVertex = false, vertexSeen = false;
+  uint64_t skipBytes = 0;     // records of the elements in front of the vertices
+  uint64_t elementCount = 0;  // of the current element
+  size_t elementStride = 0;
+  bool elementHasList = false;
+  properties.clear();
+
+  // adds the finished element in front of the vertices to skipBytes
+  auto closeElement = [&]() -> bool {
+    if (vertexSeen || inVertex || elementCount == 0) return true;
+    if (elementHasList) {
+      std::cerr << "Error: PLY elements with lists in front of the vertices are not supported." << std::endl;
+      return false;
+    }
+    skipBytes += elementCount * elementStride;
+    return true;
+  };
+
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    std::stringstream ss(line);
+    word.clear();
+    ss >> word;
+    if (!isPly) {
+      if (word != "ply") break;
+      isPly = true;
+    } else if (word == "format") {
+      ss >> format;
+    } else if (word == "element") {
+      if (!closeElement()) return false;
+      if (inVertex) vertexSeen = true;
+      std::string what;
+      ss >> what >> elementCount;
+      elementStride = 0;
+      elementHasList = false;
+      inVertex = (what == "vertex");
+      if (inVertex) vertexCount = elementCount;
+    } else if (word == "property") {
+      std::string typeName, name;
+      ss >> typeName;
+      if (typeName == "list") {
+        elementHasList = true;
+        if (inVertex) {
+          std::cerr << "Error: PLY vertex lists are not supported." << std::endl;
+          return false;
+        }
+        continue;
+      }
+      ss >> name;
+      PlyType type;
+      if (!parsePlyType(typeName, type)) {
+        std::cerr << "Error: Unknown PLY property type: " << typeName << std::endl;
+        return false;
+      }
+      if (inVertex) properties.push_back(PlyProperty{name, type, elementStride});
+      elementStride += plyTypeSize(type);
+      if (inVertex) stride = elementStride;
+    } else if (word == "end_header") {
+      if (!closeElement()) return false;
+      headerEnded = true;
+      break;
+    }
+  }
+
+  if (!isPly || !headerEnded || vertexCount == 0 || stride == 0) {
+    std::cerr << "Error: Invalid PLY header." << std::endl;
+    return false;
+  }
+  if (format == "binary_little_endian") {
+    encoding = PLY_BINARY_LE;
+  } else if (format == "binary_big_endian") {
+    encoding = PLY_BINARY_BE;
+  } else {
+    encoding = PLY_ASCII;
+    std::cerr << "Error: PLY format " << format << " is not supported, convert the file to binary first." << std::endl;
+    return false;
+  }
+
+  auto find = [&](std::initializer_list<const char*> names) {
+    for (const char* n : names) {
+      for (size_t i = 0; i < properties.size(); i++) {
+        if (properties[i].name == n) return (int)i;
+      }
+    }
+    return -1;
+  };
+  x = find({"x"});
+  y = find({"y"});
+  z = find({"z"});
+  r = find({"red", "r", "diffuse_red"});
+  g = find({"green", "g", "diffuse_green"});
+  b = find({"blue", "b", "diffuse_blue"});
+  if (x < 0 || y < 0 || z < 0) {
+    std::cerr << "Error: PLY vertices have no x, y and z." << std::endl;
+    return false;
+  }
+  if (!hasColor()) {
+    std::cerr << "Warning: PLY vertices have no color, drawing them white." << std::endl;
+    r = g = b = -1;
+  }
+
+  std::streampos headerEnd = in.tellg();
+  if (headerEnd < 0) return false;
+  dataOffset = (uint64_t)headerEnd + skipBytes;
+  in.seekg((std::streamoff)dataOffset);
+  return true;
+}
+
+/**
+ * @brief true if the records have to be byte swapped on this machine
+ */
+bool PlyLayout::needsSwap() const {
+  const uint16_t one = 1;
+  bool littleHost = *reinterpret_cast<const unsigned char*>(&one) == 1;
+  return (encoding == PLY_BINARY_BE) == littleHost;
+}
+
+namespace {
+
+/** @brief Reverse the bytes of a scalar */
+template <typename T>
+inline T byteSwap(T v) {
+  if constexpr (sizeof(T) > 1) {
+    unsigned char b[sizeof(T)];
+    std::memcpy(b, &v, sizeof(T));
+    std::reverse(b, b + sizeof(T));
+    std::memcpy(&v, b, sizeof(T));
+  }
+  return v;
+}
+
+/** @brief Unaligned load of a scalar from a record */
+template <typename T, bool Swap>
+inline T load(const unsigned char* p) {
+  T v;
+  std::memcpy(&v, p, sizeof(T));
+  return Swap ? byteSwap(v) : v;
+}
+
+/** @brief Tag of layouts without color */
+struct NoColor {};
+
+// ---- column conversions, the part that runs on every value ----
+inline void toFloat(const float* src, float* dst, size_t n) {
+  std::memcpy(dst, src, n * sizeof(float));
+}
+
+inline void toFloat(const double* src, float* dst, size_t n) {
+  size_t i = 0;
+#if defined(__AVX__)
+  for (; i + 4 <= n; i += 4) {
+    _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_loadu_pd(src + i)));
+  }
+#elif defined(__SSE2__)
+  for (; i + 4 <= n; i += 4) {
+    __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+    __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+    _mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+  }
+#endif
+  for (; i < n; i++) dst[i] = (float)src[i];
+}
+
+inline void toUnit(const uint8_t* src, float* dst, size_t n) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i lo = _mm_unpacklo_epi8(v, zero);
+    __m128i hi = _mm_unpackhi_epi8(v, zero);
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+    _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+    _mm_storeu_ps(dst + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+    _mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+  }
+#endif
+  for (; i < n; i++) dst[i] = src[i] * (1.0f / 255.0f);
+}
+
+inline void toUnit(const uint16_t* src, float* dst, size_t n) {
+  for (size_t i = 0; i < n; i++) dst[i] = src[i] * (1.0f / 65535.0f);
+}
+
+inline void toUnit(const float* src, float* dst, size_t n) {
+  toFloat(src, dst, n);
+}
+
+/**
+ * @brief Decoder compiled for one layout: positions of type P, colors of type C
+ *
+ * A batch of records is gathered into columns first (byte swapped if
+ * needed) and each column is converted in one SIMD pass, then the columns
+ * are interleaved into Points.
+ */
+template <typename P, typename C, bool Swap>
+void decodeTyped(const PlyLayout& layout, const unsigned char* records, size_t n, Point* out) {
+  constexpr bool HasColor = !std::is_same<C, NoColor>::value;
+  typedef typename std::conditional<HasColor, C, uint8_t>::type CT;
+  const size_t stride = layout.stride;
+  const size_t ox = layout.properties[layout.x].offset;
+  const size_t oy = layout.properties[layout.y].offset;
+  const size_t oz = layout.properties[layout.z].offset;
+  const size_t cr = HasColor ? layout.properties[layout.r].offset : 0;
+  const size_t cg = HasColor ? layout.properties[layout.g].offset : 0;
+  const size_t cb = HasColor ? layout.properties[layout.b].offset : 0;
+
+  P px[PLY_BATCH], py[PLY_BATCH], pz[PLY_BATCH];
+  CT pr[PLY_BATCH], pg[PLY_BATCH], pb[PLY_BATCH];
+  float fx[PLY_BATCH], fy[PLY_BATCH], fz[PLY_BATCH];
+  float fr[PLY_BATCH], fg[PLY_BATCH], fb[PLY_BATCH];
+
+  for (size_t first = 0; first < n; first += PLY_BATCH) {
+    const size_t m = std::min(PLY_BATCH, n - first);
+    const unsigned char* rec = records + first * stride;
+    for (size_t i = 0; i < m; i++, rec += stride) {
+      px[i] = load<P, Swap>(rec + ox);
+      py[i] = load<P, Swap>(rec + oy);
+      pz[i] = load<P, Swap>(rec + oz);
+      if constexpr (HasColor) {
+        pr[i] = load<CT, Swap>(rec + cr);
+        pg[i] = load<CT, Swap>(rec + cg);
+        pb[i] = load<CT, Swap>(rec + cb);
+      }
+    }
+
+    toFloat(px, fx, m);
+    toFloat(py, fy, m);
+    toFloat(pz, fz, m);
+    if constexpr (HasColor) {
+      toUnit(pr, fr, m);
+      toUnit(pg, fg, m);
+      toUnit(pb, fb, m);
+    } else {
+      std::fill(fr, fr + m, 1.0f);
+      std::fill(fg, fg + m, 1.0f);
+      std::fill(fb, fb + m, 1.0f);
+    }
+
+    Point* o = out + first;
+    for (size_t i = 0; i < m; i++) {
+      o[i] = Point{glm::vec3(fx[i], fy[i], fz[i]), glm::vec3(fr[i], fg[i], fb[i])};
+    }
+  }
+}
+
+/** @brief One value of any type, as double */
+inline double loadAny(PlyType type, const unsigned char* p, bool swap) {
+  switch (type) {
+    case PLY_INT8: return (double)load<int8_t, false>(p);
+    case PLY_UINT8: return (double)load<uint8_t, false>(p);
+    case PLY_INT16: return swap ? load<int16_t, true>(p) : load<int16_t, false>(p);
+    case PLY_UINT16: return swap ? load<uint16_t, true>(p) : load<uint16_t, false>(p);
+    case PLY_INT32: return swap ? load<int32_t, true>(p) : load<int32_t, false>(p);
+    case PLY_UINT32: return swap ? load<uint32_t, true>(p) : load<uint32_t, false>(p);
+    case PLY_FLOAT32: return swap ? load<float, true>(p) : load<float, false>(p);
+    default: return swap ? load<double, true>(p) : load<double, false>(p);
+  }
+}
+
+/** @brief Divisor that maps a color channel of the type to [0, 1] */
+inline double unitScale(PlyType type) {
+  switch (type) {
+    case PLY_INT8: return 127.0;
+    case PLY_UINT8: return 255.0;
+    case PLY_INT16: return 32767.0;
+    case PLY_UINT16: return 65535.0;
+    case PLY_INT32: return 2147483647.0;
+    case PLY_UINT32: return 4294967295.0;
+    default: return 1.0;
+  }
+}
+
+/**
+ * @brief Decoder for any layout, switches on the type of every value
+ */
+void decodeGeneric(const PlyLayout& layout, const unsigned char* records, size_t n, Point* out) {
+  const bool swap = layout.needsSwap();
+  const PlyProperty* pos[3] = { &layout.properties[layout.x], &layout.properties[layout.y], &layout.properties[layout.z] };
+  const PlyProperty* col[3] = { nullptr, nullptr, nullptr };
+  if (layout.hasColor()) {
+    col[0] = &layout.properties[layout.r];
+    col[1] = &layout.properties[layout.g];
+    col[2] = &layout.properties[layout.b];
+  }
+  for (size_t i = 0; i < n; i++) {
+    const unsigned char* rec = records + i * layout.stride;
+    glm::vec3 p, c(1.0f);
+    for (int k = 0; k < 3; k++) {
+      p[k] = (float)loadAny(pos[k]->type, rec + pos[k]->offset, swap);
+      if (col[k] != nullptr) {
+        double v = loadAny(col[k]->type, rec + col[k]->offset, swap) / unitScale(col[k]->type);
+        c[k] = (float)std::min(1.0, std::max(0.0, v));
+      }
+    }
+    out[i] = Point{p, c};
+  }
+}
+
+/** @brief Decoder for positions of type P, by color type */
+template <typename P, bool Swap>
+VertexDecoder::DecodeFn pickColor(const PlyLayout& layout) {
+  if (!layout.hasColor()) return decodeTyped<P, NoColor, Swap>;
+  PlyType t = layout.properties[layout.r].type;
+  if (layout.properties[layout.g].type != t || layout.properties[layout.b].type != t) return nullptr;
+  switch (t) {
+    case PLY_UINT8: return decodeTyped<P, uint8_t, Swap>;
+    case PLY_UINT16: return decodeTyped<P, uint16_t, Swap>;
+    case PLY_FLOAT32: return decodeTyped<P, float, Swap>;
+    default: return nullptr;
+  }
+}
+
+/** @brief Decoder for the byte order Swap, by position type */
+template <bool Swap>
+VertexDecoder::DecodeFn pickPosition(const PlyLayout& layout) {
+  switch (layout.properties[layout.x].type) {
+    case PLY_FLOAT32: return pickColor<float, Swap>(layout);
+    case PLY_FLOAT64: return pickColor<double, Swap>(layout);
+    default: return nullptr;
+  }
+}
+
+} // namespace
+
+/**
+ * @brief Pick the decoder for a layout
+ */
+bool VertexDecoder::init(const PlyLayout& layout_) {
+  layout = layout_;
+  if (layout.x < 0 || layout.y < 0 || layout.z < 0 || layout.stride == 0) return false;
+
+  const PlyType pos = layout.properties[layout.x].type;
+  const bool samePos = layout.properties[layout.y].type == pos && layout.properties[layout.z].type == pos;
+  fn = nullptr;
+  if (samePos) {
+    fn = layout.needsSwap() ? pickPosition<true>(layout) : pickPosition<false>(layout);
+  }
+
+  const char* typeNames[] = { "int8", "uint8", "int16", "uint16", "int32", "uint32", "float32", "float64" };
+  std::string color = layout.hasColor() ? typeNames[layout.properties[layout.r].type] : "none";
+  decoderName = std::string(fn != nullptr ? "" : "generic ") + typeNames[pos] + " xyz, " + color + " rgb" +
+                (layout.encoding == PLY_BINARY_BE ? ", big endian" : "");
+  if (fn == nullptr) fn = decodeGeneric;
+  return true;
+}
+
+/**
+ * @brief Decode n records
+ */
+void VertexDecoder::decode(const unsigned char* records, size_t n, Point* out) const {
+  fn(layout, records, n, out);
+}
@@ -7,17 +7,20 @@
 //=============================================================================
 
 #include "Rasterizer.h"
-#include <stb_image_write.h>
 #include <stb_image.h>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include "DataManager.h"
 #include "Shader.h"
 #include "Utils.h"
+#include "GLExt.h"
 #include <iostream>
 #include <cstdio>
 #include <cfloat>
+#include <cmath>
 #include <limits>
+#include <cstddef>
+#include <cstring>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -32,20 +35,40 @@ Rasterizer::~Rasterizer(){
     delete shader;
   }
 
+  // no-op after render(), joins the workers if init() failed half way
+  dataManager.quit();
+
+  // GL objects go first, while the context of the window is still alive
+  if (glInitialized) {
+    // Cleanup VAO/VBO for in-core blocks
+    for (auto& block : blocks) {
+      if (block.vao != 0) glDeleteVertexArrays(1, &block.vao);
+      if (block.vbo != 0) glDeleteBuffers(1, &block.vbo);
+    }
+
+    // slots and cached slots share the arena
+    subSlots.clear();
+    arena.destroy();
+
+    stagingRing.destroy();
+    occlusion.destroy();
+    compute.destroy();
+    exporter.destroy();
+    profilerGPU.destroy();
+    for (GLsync& f : frameFences) {
+      if (f != nullptr) glDeleteSync(f);
+      f = nullptr;
+    }
+    if (offscreenFBO != 0) glDeleteFramebuffers(1, &offscreenFBO);
+    if (offscreenColor != 0) glDeleteRenderbuffers(1, &offscreenColor);
+    if (offscreenDepth != 0) glDeleteRenderbuffers(1, &offscreenDepth);
+  }
+
   if (window != nullptr) {
     glfwDestroyWindow(window);
     window = nullptr;
   }
 
-  // Cleanup VAO/VBO for active slots
-  for (auto& slot : slots) {
-    if (slot.vao != 0) glDeleteVertexArrays(1, &slot.vao);
-    if (slot.vbo != 0) glDeleteBuffers(1, &slot.vbo);
-  }
-
-  // Cleanup VAO/VBO for cached slots
-  subSlots.clear();
-
   // glfw: terminate, clearing all previously allocated GLFW resources.
   glfwTerminate();
 }
@@ -54,49 +77,85 @@ Rasterizer::~Rasterizer(){
  * @brief Initialize the rasterizer with rendering parameters
  * @return true if initialization succeeds, false otherwise
  */
-bool Rasterizer::init(const std::filesystem::path& plyPath_,
-                      const std::filesystem::path& outDir_,
-                      const std::filesystem::path& shader_vert_,
-                      const std::filesystem::path& shader_frag_,
-                      bool isTest_,
-                      bool isOOC_,
-                      bool isCache_,
-                      bool isExport_,
-                      unsigned int window_width_,
-                      unsigned int window_height_,
-                      float z_near_,
-                      float z_far_,
-                      float rotateAngle_,
-                      float distanceFactor_,
-                      float slotFactor_){
+bool Rasterizer::init(const RasterizerConfig& config){
   // Set member variables
-  plyPath = plyPath_;
-  outDir = outDir_;
-  shader_vert = shader_vert_;
-  shader_frag = shader_frag_;
-  isTest = isTest_;
-  isOOC = isOOC_;
-  isCache = isCache_;
-  isExport = isExport_;
-  window_width = window_width_;
-  window_height = window_height_;
-  z_near = z_near_;
-  z_far = z_far_;
-  angularSpeed = glm::radians(rotateAngle_);
-  distFactor = distanceFactor_; // for orbital camera pose in test mode
-  slotFactor = slotFactor_;
-  blocks.resize(NUM_BLOCKS);
+  plyPath = config.plyPath;
+  outDir = config.outDir;
+  shader_vert = config.shader_vert;
+  shader_frag = config.shader_frag;
+  shader_occlusion_vert = config.shader_occlusion_vert;
+  shader_occlusion_frag = config.shader_occlusion_frag;
+  shader_compute = config.shader_compute;
+  shader_resolve_vert = config.shader_resolve_vert;
+  shader_resolve_frag = config.shader_resolve_frag;
+  renderBackend = config.renderBackend;
+  isProgressive = config.isProgressive;
+  progressiveBlocks = std::max(1, config.progressiveBlocks);
+  if (isProgressive && renderBackend == RENDER_COMPUTE) {
+    // the compute framebuffer is cleared by every frame
+    std::cerr << "Warning: --progressive needs the points backend, disabled." << std::endl;
+    isProgressive = false;
+  }
+  isTest = config.isTest;
+  isOOC = config.isOOC;
+  isCache = config.isCache;
+  isExport = config.isExport;
+  isHeadless = config.isHeadless;
+  exportDir = config.exportDir;
+  exportFormat = config.exportFormat;
+  exportWriters = config.exportWriters;
+  isAsync = config.isAsync;
+  isRebuild = config.isRebuild;
+  isPersistent = config.isPersistent;
+  isLOD = config.isLOD;
+  lodDensity = config.lodDensity;
+  partitionConfig = config.partition;
+  tracePath = config.tracePath;
+  window_width = config.window_width;
+  window_height = config.window_height;
+  z_near = config.z_near;
+  z_far = config.z_far;
+  angularSpeed = glm::radians(config.rotateAngle);
+  distFactor = config.distanceFactor; // for orbital camera pose in test mode
+  slotFactor = config.slotFactor;
+  subslotRatio = config.subslotRatio;
+  cachePolicy = config.cachePolicy;
+  numWorkers = config.numWorkers;
+  io = config.io;
+  uploadBudgetBytes = (size_t)(config.uploadBudgetMB * 1024.0f * 1024.0f);
+  uploadBudgetMs = config.uploadBudgetMs;
+  warmup = config.warmup;
+  N = config.frames;
+  fixedDt = config.fixedDt;
+  cameraRecordPath = config.cameraRecordPath;
+  isPrefetch = config.isPrefetch && config.isOOC && config.isCache;
+  prefetchFrames = config.prefetchFrames;
+  cullThreads = config.cullThreads;
+  isOcclusion = config.isOcclusion;
+  occlusionSamples = config.occlusionSamples;
+  targetFrameMs = config.targetFrameMs;
+  vramFraction = config.vramFraction;
+  if (!config.cameraPath.empty()) {
+    if (!cameraPath.load(config.cameraPath)) return false;
+    isReplay = true;
+    std::cout << "Replaying camera path of " << cameraPath.size() << " frames." << std::endl;
+  }
+  // nobody at the keyboard, orbit like --test unless a path is replayed
+  if (isHeadless && !isReplay) isTest = true;
 
   // setups
   if (!setupWindow()) return false;
   if (!setupDataManager()) return false;
   if (!filterBlocks()) return false;
   if (!setupRasterizer()) return false;
+  if (!setupOffscreen()) return false; // before anything asks for the framebuffer size
   if (!setupCameraPose()) return false;
   if (!setupCallbacks()) return false;
   if (!setupShader()) return false; // before setupCulling()
   if (!setupCulling()) return false;
   if (!setupBufferWrapper()) return false;
+  if (!setupBackend()) return false; // after the slot arena
+  if (!setupExport()) return false;
   return true;
 }
 
@@ -111,6 +170,7 @@ bool Rasterizer::setupRasterizer(){
     return false;
   }
   glInitialized = true;
+  loadGLExtensions((GLADloadproc)glfwGetProcAddress);
   glViewport(0, 0, window_width, window_height);
   glEnable(GL_DEPTH_TEST);
   glPointSize(1.0f);
@@ -126,8 +186,8 @@ bool Rasterizer::setupCameraPose(){
   diag = glm::length((bb_max - bb_min));
 
   // Put camera: above (+Y) and in front (+Z or -Z depending on your world)
-  // Take 5% of diag
-  camera_position = center + glm::vec3(0.05f * diag, 0.05f * diag, 0.05f * diag);
+  // Take distFactor (e.g. 5%) of diag
+  camera_position = center + glm::vec3(distFactor * diag, distFactor * diag, distFactor * diag);
   camera.changePose(camera_position, center);
   return true;
 }
@@ -156,8 +216,13 @@ bool Rasterizer::setupShader(){
   shader->use();
   model = glm::mat4(1.0f); // identity for now
   proj = glm::perspective(glm::radians(45.0f), (float)window_width / (float)window_height, z_near, z_far);
+  focalPx = 0.5f * (float)window_height / std::tan(0.5f * glm::radians(45.0f));
   shader->setMat4("Model", model);
   shader->setMat4("Proj", proj);
+
+  // set per draw, so look the locations up once
+  locBlockMin = glGetUniformLocation(shader->ID, "BlockMin");
+  locBlockExtent = glGetUniformLocation(shader->ID, "BlockExtent");
   return true;
 }
 
@@ -166,7 +231,17 @@ bool Rasterizer::setupShader(){
  * @return true if culling setup succeeds
  */
 bool Rasterizer::setupCulling(){
-  buildFrustumPlanes();
+  // bounds are fixed after filterBlocks(), copy them once
+  culler.init(blocks, cullThreads);
+  if (isOcclusion) {
+    if (occlusion.init(blocks, shader_occlusion_vert.c_str(), shader_occlusion_frag.c_str(), occlusionSamples)) {
+      std::cout << "Occlusion culling: box queries, " << OCCLUSION_MAX_QUERIES << " per frame." << std::endl;
+    } else {
+      std::cerr << "Warning: --occlusion could not be set up, disabled." << std::endl;
+      occlusion.destroy();
+      isOcclusion = false;
+    }
+  }
   return true;
 }
 
@@ -180,12 +255,22 @@ bool Rasterizer::setupWindow(){
     std::cerr << "Failed to initialize GLFW" << std::endl;
     return false;
   }
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  // compute shaders need a 4.3 context
+  bool wantCompute = (renderBackend == RENDER_COMPUTE);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, wantCompute ? 4 : 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  // headless: the window only carries the context, frames go to an offscreen framebuffer
+  glfwWindowHint(GLFW_VISIBLE, isHeadless ? GLFW_FALSE : GLFW_TRUE);
 
   // glfw window creation
   window = glfwCreateWindow(window_width, window_height, "MyRasterizer", NULL, NULL);
+  if (window == NULL && wantCompute) {
+    std::cout << "No OpenGL 4.3 context, falling back to GL_POINTS." << std::endl;
+    renderBackend = RENDER_POINTS;
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    window = glfwCreateWindow(window_width, window_height, "MyRasterizer", NULL, NULL);
+  }
   if (window == NULL) {
     std::cout << "Failed to create GLFW window" << std::endl;
     glfwTerminate();
@@ -206,6 +291,8 @@ bool Rasterizer::setupCallbacks(){
   if (window == nullptr){
     return false;
   }
+  // hidden window: the size is fixed, the camera does not take input
+  if (isHeadless) return true;
   glfwSetFramebufferSizeCallback(window, Rasterizer::framebuffer_size_callback);
   glfwSetCursorPosCallback(window, Rasterizer::mouse_callback);
   glfwSetWindowFocusCallback(window, Rasterizer::window_focus_callback);
@@ -221,6 +308,84 @@ bool Rasterizer::setupCallbacks(){
   return true;
 }
 
+/**
+ * @brief Create the offscreen framebuffer of headless and progressive mode
+ *
+ * Color and depth renderbuffers at the requested resolution, bound for the
+ * whole run; frame export reads its color attachment. Progressive mode
+ * needs it because the back buffer of the window is undefined after a swap,
+ * so nothing can be accumulated there; the frames are copied into the
+ * window by presentOffscreen().
+ */
+bool Rasterizer::setupOffscreen() {
+  if (!isHeadless && !isProgressive) return true;
+  glGenRenderbuffers(1, &offscreenColor);
+  glBindRenderbuffer(GL_RENDERBUFFER, offscreenColor);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, window_width, window_height);
+  glGenRenderbuffers(1, &offscreenDepth);
+  glBindRenderbuffer(GL_RENDERBUFFER, offscreenDepth);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, window_width, window_height);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glGenFramebuffers(1, &offscreenFBO);
+  glBindFramebuffer(GL_FRAMEBUFFER, offscreenFBO);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, offscreenColor);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, offscreenDepth);
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "Error: Offscreen framebuffer incomplete (0x" << std::hex << status << std::dec << ")" << std::endl;
+    return false;
+  }
+  glViewport(0, 0, window_width, window_height);
+  std::cout << (isHeadless ? "Headless" : "Progressive") << ": rendering offscreen at " << window_width << "x" << window_height << std::endl;
+  return true;
+}
+
+/**
+ * @brief Size of the framebuffer rendered into, offscreen or the window's
+ */
+void Rasterizer::framebufferSize(int& w, int& h) const {
+  if (offscreenFBO != 0) {
+    w = (int)window_width;
+    h = (int)window_height;
+    return;
+  }
+  glfwGetFramebufferSize(window, &w, &h);
+}
+
+/**
+ * @brief End a headless frame in place of the swap
+ *
+ * Without a swap nothing throttles the CPU, so it could queue frames far
+ * ahead of the GPU. A fence per frame keeps at most HEADLESS_FRAMES in
+ * flight, like a double-buffered swap chain without vsync.
+ */
+void Rasterizer::presentHeadless() {
+  GLsync& oldest = frameFences[frameFence];
+  if (oldest != nullptr) {
+    glClientWaitSync(oldest, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    glDeleteSync(oldest);
+  }
+  oldest = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush();
+  frameFence = (frameFence + 1) % HEADLESS_FRAMES;
+}
+
+/**
+ * @brief Copy the offscreen framebuffer into the window
+ *
+ * Scaled to the current size of the window, the offscreen frame keeps the
+ * size it was created with.
+ */
+void Rasterizer::presentOffscreen() {
+  int w = 0, h = 0;
+  glfwGetFramebufferSize(window, &w, &h);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, offscreenFBO);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  glBlitFramebuffer(0, 0, (GLint)window_width, (GLint)window_height, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+  glBindFramebuffer(GL_FRAMEBUFFER, offscreenFBO);
+}
+
 /**
  * @brief Initialize data manager and load point cloud data
  * @return true if data manager initialization succeeds, false otherwise
@@ -231,8 +396,14 @@ bool Rasterizer::setupDataManager(){
   bb_min = glm::vec3(std::numeric_limits<float>::max());
   bb_max = glm::vec3(std::numeric_limits<float>::lowest());
 
+  // trace buffers are allocated per thread on first use, so enable before the workers start
+  if (!tracePath.empty()) profilerCPU.enableTrace();
+  profilerCPU.setThreadName("main");
+  dataManager.setProfiler(&profilerCPU);
+  dataManager.setIO(io);
+
   // initialize Data Manager
-  if(!dataManager.init(plyPath, outDir, isOOC, bb_min, bb_max, blocks, vertexCount)){
+  if(!dataManager.init(plyPath, outDir, isOOC, isRebuild, partitionConfig, numWorkers, bb_min, bb_max, blocks, vertexCount)){
     std::cerr << "Error: DataManager.init(). Exiting." << std::endl;
     return false;
   }
@@ -254,6 +425,7 @@ bool Rasterizer::setupDataManager(){
  * @brief Filter out empty blocks
  */
 bool Rasterizer::filterBlocks(){
+  size_t total = blocks.size();
   size_t k = 0;
   while (k < blocks.size()) {
     if (blocks[k].count == 0) {
@@ -262,7 +434,7 @@ bool Rasterizer::filterBlocks(){
       k++;
     }
   }
-  std::cout << "Filtered empty blocks from " << NUM_BLOCKS << " to " << blocks.size() << " blocks." << std::endl;
+  std::cout << "Filtered empty blocks from " << total << " to " << blocks.size() << " blocks." << std::endl;
   return true;
 }
 
@@ -272,26 +444,80 @@ bool Rasterizer::filterBlocks(){
  */
 bool Rasterizer::setupBufferWrapper(){
   num_slots = (int)(slotFactor * blocks.size());
-  num_subSlots = (int)(0.5f*slotFactor * blocks.size());
+  num_subSlots = (int)(subslotRatio * slotFactor * blocks.size());
   num_points_per_slot = (int)(vertexCount/blocks.size());
+  if (partitionConfig.mode == PARTITION_KD) {
+    // k-d blocks are close in size, so a slot can hold the largest one whole
+    for (const Block& b : blocks) num_points_per_slot = std::max(num_points_per_slot, b.count);
+  }
+  if (targetFrameMs > 0.0f) setupBudget();
   std::cout << "num_slots: " << num_slots << "\n";
   std::cout << "num_subSlots: " << num_subSlots << "\n";
   std::cout << "num_points_per_slot: " << num_points_per_slot << "\n";
   return isOOC ? setupSlots() : setupBufferPerBlock();
 }
 
+/**
+ * @brief Size the slot capacity to the free video memory and start the controller
+ *
+ * The arena is one buffer allocated once, so the controller can only move
+ * within the regions it gets here. Out-of-core the capacity grows up to one
+ * slot per block (subslots keep their ratio), as much as vramFraction of the
+ * free video memory holds; without a memory query it stays at the configured
+ * count. In-core every block is resident anyway and all can be drawn. The
+ * controller starts at the configured slot count, or below if it did not fit.
+ */
+void Rasterizer::setupBudget() {
+  int configured = num_slots;
+  int capacity = (int)blocks.size();
+  if (isOOC) {
+    uint64_t freeBytes = 0;
+    if (queryFreeVRAM(freeBytes)) {
+      double regionBytes = (double)num_points_per_slot * sizeof(PointQ);
+      double regions = (double)freeBytes * vramFraction / regionBytes - (isProgressive ? PROGRESSIVE_REGIONS : 0);
+      double perSlot = 1.0 + (isCache ? subslotRatio : 0.0);
+      capacity = (int)std::min<double>(capacity, std::max(1.0, regions / perSlot));
+      std::cout << "Free video memory: " << freeBytes / (1024 * 1024) << " MB, room for "
+                << capacity << " slots" << std::endl;
+    } else {
+      capacity = std::max(1, configured);
+      std::cout << "Free video memory unknown (no GL_NVX_gpu_memory_info / GL_ATI_meminfo), "
+                << "slots stay at " << capacity << std::endl;
+    }
+    num_subSlots = (int)(subslotRatio * capacity);
+  }
+  num_slots = capacity; // slotBudget() clamps to it, so it has to span the controller's range
+  int minSlots = std::max(1, (int)(BUDGET_MIN_SLOT_SHARE * capacity));
+  frameBudget.init(targetFrameMs, minSlots, capacity, std::min(configured, capacity));
+  std::cout << "Frame time budget: " << targetFrameMs << " ms, slots " << minSlots << " - "
+            << capacity << ", starting at " << frameBudget.slots() << std::endl;
+}
+
+/**
+ * @brief Slots drawn per frame, the controller's share of num_slots
+ */
+int Rasterizer::slotBudget() const {
+  return frameBudget.enabled() ? std::min(frameBudget.slots(), num_slots) : num_slots;
+}
+
 /**
  * @brief Setup OpenGL buffers per block for in-core rendering
  * @return true if setup is successful
  */
 bool Rasterizer::setupBufferPerBlock(){
   for (int i = 0; i < blocks.size(); i++) {
-    setupBuffer(blocks[i].vao, blocks[i].vbo, blocks[i].count, sizeof(Point));
-    // Upload actual point data for in-core rendering
+    setupBuffer(blocks[i].vao, blocks[i].vbo, blocks[i].count, sizeof(PointQ));
+  }
+  // Upload actual point data for in-core rendering, while the next blocks are still loading
+  bool ok = dataManager.loadInCore(blocks, [this](int i, const PointQ* points) {
     glBindBuffer(GL_ARRAY_BUFFER, blocks[i].vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, blocks[i].count * sizeof(Point), blocks[i].points.data());
+    glBufferSubData(GL_ARRAY_BUFFER, 0, blocks[i].count * sizeof(PointQ), points);
+  });
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  if (!ok) {
+    std::cerr << "Error: Failed to load the blocks for in-core rendering." << std::endl;
   }
-  return true;
+  return ok;
 }
 
 void Rasterizer::setupBuffer(unsigned int& vao, unsigned int& vbo, int count, int size){
@@ -304,13 +530,13 @@ void Rasterizer::setupBuffer(unsigned int& vao, unsigned int& vbo, int count, in
   // Allocate buffer storage (no data yet)
   glBufferData(GL_ARRAY_BUFFER, count * size, nullptr, GL_STREAM_DRAW);
 
-  // attrib 0: position (vec3)
+  // attrib 0: quantized position (3 x uint16, normalized to [0,1] within the block bbox)
   glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, size, (void*)0);
+  glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, size, (void*)offsetof(PointQ, x));
 
-  // attrib 1: color (vec3)
+  // attrib 1: color (RGBA8, normalized)
   glEnableVertexAttribArray(1);
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, size, (void*)(sizeof(glm::vec3)));
+  glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, size, (void*)offsetof(PointQ, r));
 
   glBindVertexArray(0);
   glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -324,13 +550,42 @@ bool Rasterizer::setupSlots() {
 
   slots.resize(num_slots);
 
-  // initialize slots
+  // one region per slot and per subslot, all in one VBO, plus the spare ones of progressive mode
+  int num_regions = num_slots + (isCache ? num_subSlots : 0) + (isProgressive ? PROGRESSIVE_REGIONS : 0);
+  if (!arena.init(num_regions, num_points_per_slot, sizeof(PointQ))) {
+    return false;
+  }
   for (int i = 0; i < num_slots; i++) {
-    setupBuffer(slots[i].vao, slots[i].vbo, num_points_per_slot, sizeof(Point));
+    slots[i].region = arena.acquire();
+  }
+  progressiveFree.clear();
+  for (int i = 0; isProgressive && i < PROGRESSIVE_REGIONS; i++) {
+    progressiveFree.push_back(arena.acquire());
   }
 
+  // region frames are looked up in the vertex shader
+  shader->use();
+  shader->setInt("PointsPerRegion", num_points_per_slot);
+  shader->setInt("RegionFrames", 0);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_BUFFER, arena.frames());
+  std::cout << "Slot arena: " << num_regions << " regions, "
+            << (glCaps.multiDrawIndirect ? "glMultiDrawArraysIndirect" : "glMultiDrawArrays") << std::endl;
+
+  residency.init(dataManager.getNumBlocks());
   if (isCache){
-    subSlots.init(num_subSlots);
+    blockScore.assign(dataManager.getNumBlocks(), 0.0f);
+    subSlots.init(num_subSlots, &residency, cachePolicy, &blockScore);
+    std::cout << "Subslots cache policy: " << cachePolicyName(cachePolicy) << std::endl;
+  }
+
+  // optional persistently mapped upload path, GL 3.3 glBufferSubData otherwise
+  if (isPersistent) {
+    if (stagingRing.init((size_t)num_points_per_slot * sizeof(PointQ), STAGING_REGIONS)) {
+      std::cout << "Uploading through persistently mapped staging ring (" << STAGING_REGIONS << " regions)." << std::endl;
+    } else {
+      std::cout << "GL_ARB_buffer_storage not available, falling back to glBufferSubData uploads." << std::endl;
+    }
   }
 
   return true;
@@ -338,23 +593,6 @@ bool Rasterizer::setupSlots() {
 
 
 
-/**
- * @brief Extract frustum planes from projection matrix
- */
-void Rasterizer::buildFrustumPlanes() {
-
-  // GLM matrices are column-major. Transpose to treat m[i] as row i.
-  glm::mat4 m = glm::transpose(proj);
-
-  // Plane updates: n and d
-  planes[0] = normalizePlane(m[3] + m[0]); // Left
-  planes[1] = normalizePlane(m[3] - m[0]); // Right
-  planes[2] = normalizePlane(m[3] + m[1]); // Bottom
-  planes[3] = normalizePlane(m[3] - m[1]); // Top
-  planes[4] = normalizePlane(m[3] + m[2]); // Near
-  planes[5] = normalizePlane(m[3] - m[2]); // Far
-}
-
 /**
  * @brief Clear color and depth buffers
  */
@@ -363,6 +601,23 @@ void Rasterizer::clear() {
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
+/**
+ * @brief Set up the compute backend, falls back to GL_POINTS without GL 4.3
+ */
+bool Rasterizer::setupBackend() {
+  if (renderBackend != RENDER_COMPUTE) return true;
+  int w = 0, h = 0;
+  framebufferSize(w, h);
+  if (!compute.init(w, h, shader_compute.c_str(), shader_resolve_vert.c_str(), shader_resolve_frag.c_str())) {
+    std::cout << "Compute backend not available, falling back to GL_POINTS." << std::endl;
+    renderBackend = RENDER_POINTS;
+    return true;
+  }
+  if (isOOC) arena.setCompute(&compute);
+  std::cout << "Render backend: compute, " << (compute.uses64BitAtomics() ? "64-bit atomicMin" : "two 32-bit passes") << std::endl;
+  return true;
+}
+
 /**
  * @brief Set view matrix in shader
  */
@@ -370,90 +625,167 @@ void Rasterizer::setShaderView() {
   view = camera.GetViewMatrix();
   shader->use();
   shader->setMat4("View", view);
+  if (renderBackend == RENDER_COMPUTE) {
+    int w = 0, h = 0;
+    framebufferSize(w, h);
+    compute.resize(w, h);
+    compute.begin(proj * view * model);
+  }
 }
 
 /**
  * @brief Cull blocks against view frustum
  */
 void Rasterizer::cullBlocks(){
-  visibleCount = blocks.size();
-  for (int i = 0; i < blocks.size(); i++){
-    aabbIntersectsFrustum(blocks[i]);
+  culler.cull(proj, view, z_near, z_far, cullOut);
+  // occlusion results of earlier frames, hidden blocks neither take a slot nor get drawn
+  if (isOcclusion) occlusion.collect();
+
+  // gather the results into the blocks
+  visibleCount = 0;
+  occludedCount = 0;
+  for (Block& block : blocks) {
+    int id = block.blockID;
+    block.distanceToPlaneMin = cullOut.planeDist[id];
+    block.distanceToCameraCenter = cullOut.cameraDist[id];
+    block.distanceToFrustumCenter = cullOut.frustumCenterDist[id];
+    bool inFrustum = (block.distanceToPlaneMin >= 0.0f);
+    block.isVisible = inFrustum && !(isOcclusion && occlusion.isOccluded(id));
+    visibleCount += block.isVisible;
+    occludedCount += inFrustum && !block.isVisible;
+    block.lodCount = lodBudget(block);
   }
-  limit = std::min<int>(num_slots, visibleCount);
+  if (!blockScore.empty()) {
+    // cost-aware eviction keeps the blocks closest to the view
+    for (const Block& b : blocks) blockScore[b.blockID] = b.distanceToPlaneMin;
+  }
+  limit = std::min<int>(slotBudget(), visibleCount);
 }
 
 /**
- * @brief sort blocks
+ * @brief Sort key of a block: visible and near to camera center blocks first,
+ * then the invisible ones closest to the frustum (occluded ones first)
+ *
+ * Both distances are >= 0 here, so their float bits order like the floats.
  */
-void Rasterizer::sortBlocks(){
-  // sort blocks: visible and near to camera center blocks first
-  std::sort(blocks.begin(), blocks.end(),
-            [](const Block& a, const Block& b){
-              if (a.isVisible != b.isVisible) {
-                return a.isVisible > b.isVisible;
-              }
-              if (a.isVisible) {
-                return a.distanceToCameraCenter < b.distanceToCameraCenter;
-              } else{
-                return a.distanceToPlaneMin > b.distanceToPlaneMin;
-              }
-            }
-          );
-}
-
-/**
- * @brief Test if AABB intersects or is inside the frustum
- * @param block Block to test for visibility
- */
-void Rasterizer::aabbIntersectsFrustum(Block & block) {
-
-  // Generate all 8 corners of the AABB in world space
-  glm::vec3 corners[8] = {
-      glm::vec3(block.bb_min.x, block.bb_min.y, block.bb_min.z),
-      glm::vec3(block.bb_max.x, block.bb_min.y, block.bb_min.z),
-      glm::vec3(block.bb_min.x, block.bb_max.y, block.bb_min.z),
-      glm::vec3(block.bb_max.x, block.bb_max.y, block.bb_min.z),
-      glm::vec3(block.bb_min.x, block.bb_min.y, block.bb_max.z),
-      glm::vec3(block.bb_max.x, block.bb_min.y, block.bb_max.z),
-      glm::vec3(block.bb_min.x, block.bb_max.y, block.bb_max.z),
-      glm::vec3(block.bb_max.x, block.bb_max.y, block.bb_max.z)
-  };
+static uint64_t rankKey(const Block& block) {
+  float d = block.isVisible ? block.distanceToCameraCenter : std::max(0.0f, -block.distanceToPlaneMin);
+  uint32_t bits;
+  std::memcpy(&bits, &d, sizeof(bits));
+  return ((uint64_t)!block.isVisible << 32) | bits;
+}
 
-  // Transform all corners to view space and compute bounds
-  glm::vec3 bb_min(FLT_MAX);
-  glm::vec3 bb_max(-FLT_MAX);
-  for (int i = 0; i < 8; i++) {
-    glm::vec3 p = view * glm::vec4(corners[i], 1.0f);
-    bb_min = glm::min(bb_min, p);
-    bb_max = glm::max(bb_max, p);
+/**
+ * @brief Rank the blocks of this frame
+ *
+ * Only the first limit blocks (slots), the next num_subSlots (cache warm-up)
+ * and the PREFETCH_HINTS after them are read in order, so only that prefix
+ * of the ranking is sorted; the rest stays in arbitrary order. The blocks
+ * themselves never move, the ranking holds their indices.
+ */
+void Rasterizer::sortBlocks(){
+  int n = (int)blocks.size();
+  if ((int)ranking.size() != n) {
+    ranking.resize(n);
+    for (int j = 0; j < n; j++) ranking[j].index = j;
+    rankCount = 0;
   }
+  for (RankKey& r : ranking) r.key = rankKey(blocks[r.index]);
+
+  int k = std::min(n, limit + std::max(num_subSlots, PREFETCH_HINTS));
+  // last frame's order is a good start while the camera moves little
+  if (k == rankCount && rerankIncremental(k)) return;
+
+  auto less = [](const RankKey& a, const RankKey& b) { return a.key < b.key; };
+  if (k < n) std::nth_element(ranking.begin(), ranking.begin() + k, ranking.end(), less);
+  std::sort(ranking.begin(), ranking.begin() + k, less);
+  rankCount = k;
+}
 
-  // compute distance for ALL blocks (needed for sorting)
-  // Note: in view space, camera looks down -Z, so frustum center is at negative Z
-  glm::vec3 bb_center = 0.5f * (bb_min + bb_max);
-  block.distanceToCameraCenter = glm::distance(bb_center, glm::vec3(0.0f, 0.0f, 0.0f));
-  block.distanceToFrustumCenter = glm::distance(bb_center, glm::vec3(0.0f, 0.0f, -0.5f*(z_far+z_near)));
+/**
+ * @brief Repair last frame's ranking with the keys of this frame
+ *
+ * Insertion sort of the ranked prefix, then every block behind it with a
+ * smaller key than the last ranked one is swapped in and sifted down. Both
+ * are linear for small camera motion. Gives up after about the moves the
+ * nth_element and sort would have cost (one per block plus RERANK_MAX_SHIFTS
+ * per ranked block); the ranking is still a permutation then.
+ *
+ * @param k length of the ranked prefix, same as last frame
+ * @return false if the order changed too much
+ */
+bool Rasterizer::rerankIncremental(int k) {
+  if (k == 0) return true;
+  long budget = (long)ranking.size() + (long)RERANK_MAX_SHIFTS * k;
+
+  // moves ranking[i] down to its place in the sorted prefix before it
+  auto sift = [&](int i) {
+    RankKey r = ranking[i];
+    int j = i;
+    while (j > 0 && ranking[j - 1].key > r.key && budget > 0) {
+      ranking[j] = ranking[j - 1];
+      j--;
+      budget--;
+    }
+    ranking[j] = r;
+    return budget > 0;
+  };
 
-  float minDist = FLT_MAX;
-  for (const Plane &plane : planes) {
-    // Positive vertex: the AABB corner that maximizes dot(n, x)
-    glm::vec3 p;
-    p.x = (plane.n.x >= 0.0f) ? bb_max.x : bb_min.x;
-    p.y = (plane.n.y >= 0.0f) ? bb_max.y : bb_min.y;
-    p.z = (plane.n.z >= 0.0f) ? bb_max.z : bb_min.z;
-    float dist = glm::dot(plane.n, p) + plane.d;
-    minDist = std::min(dist, minDist);
+  for (int i = 1; i < k; i++) {
+    if (!sift(i)) return false;
+  }
+  for (int i = k; i < (int)ranking.size(); i++) {
+    if (ranking[i].key >= ranking[k - 1].key) continue;
+    std::swap(ranking[i], ranking[k - 1]);
+    if (!sift(k - 1) || --budget <= 0) return false;
   }
+  return true;
+}
 
-  // Decide classification once
-  block.distanceToPlaneMin = minDist;
-  block.isVisible = (minDist >= 0.0f);
-  visibleCount -= !block.isVisible;
+/**
+ * @brief Point budget of a block from its projected size on screen
+ *
+ * The bounding sphere of the block is projected with the focal length of
+ * the camera; the budget is lodDensity points per covered pixel, clamped to
+ * [LOD_MIN_POINTS, slot capacity]. Without --lod the full capacity is used.
+ * Either way the frame time budget scales it down while frames are slow.
+ */
+int Rasterizer::lodBudget(const Block& block) const {
+  int maxCount = std::min(block.count, num_points_per_slot);
+  int minCount = std::min(LOD_MIN_POINTS, maxCount);
+  float scale = frameBudget.enabled() ? frameBudget.pointScale() : 1.0f;
+  if (!isLOD) return std::max(minCount, (int)(scale * (float)maxCount));
+
+  float radius = 0.5f * glm::length(block.bb_max - block.bb_min);
+  float dist = block.distanceToCameraCenter;
+  float budget = (float)maxCount; // camera inside or touching the block
+  if (dist > radius) {
+    float px = focalPx * radius / dist;
+    budget = std::min(budget, lodDensity * 3.14159265f * px * px);
+  }
+  return std::max(minCount, (int)(scale * budget));
 }
 
-void Rasterizer::loadBlock(const int& blockID, const int& slotIdx, const int& count, const bool& loadToSlots) {
-  dataManager.enqueueBlock(blockID, slotIdx, count, loadToSlots);
+/**
+ * @brief Enqueue single block for loading
+ * @param first index of the first point, > 0 to append to a loaded slot
+ * @param priority rank of the block in this frame's sort order, lower is loaded first
+ * @return false if no staging region is free
+ */
+bool Rasterizer::loadBlock(const int& blockID, const int& slotIdx, const int& first, const int& count, const bool& loadToSlots, float priority) {
+  if (stagingRing.ready()) {
+    // the worker writes straight into the staging region
+    int region = stagingRing.acquire();
+    if (region < 0) {
+      return false;
+    }
+    dataManager.enqueueBlock(blockID, slotIdx, first, count, loadToSlots, priority, frameID, stagingRing.region(region), region);
+  } else {
+    dataManager.enqueueBlock(blockID, slotIdx, first, count, loadToSlots, priority, frameID);
+  }
+  inFlight++;
+  maxInFlight = std::max(maxInFlight, inFlight);
+  return true;
 }
 
 /**
@@ -464,10 +796,19 @@ void Rasterizer::loadBlocksOOC(){
   // load blocks to slots
   loadBlockCount = 0;
   cacheMiss = 0;
+  frameID++;
+
+  // first pass: pull blocks that are already in slots (loaded or in flight) to their index.
+  // Doing this before any slot is handed over keeps a hit from being overwritten by a miss.
   for (int i = 0; i < limit; i++) {
-    int blockID = blocks[i].blockID;
-    // see if it's already in slots
-    if (updateSlotByBlockID(blockID, i)) {
+    updateSlotByBlockID(ranked(i).blockID, i);
+  }
+
+  // second pass: cache lookups and loads for the remaining blocks
+  for (int i = 0; i < limit; i++) {
+    int blockID = ranked(i).blockID;
+    if (slots[i].blockID == blockID) {
+      refineSlot(i);
       continue;
     }
 
@@ -476,26 +817,50 @@ void Rasterizer::loadBlocksOOC(){
       // swaps extracted and slots[i]
       Slot extracted;
       if (subSlots.extract(blockID, extracted)) {
-        subSlots.put(std::move(slots[i]));
+        if (prefetched.erase(blockID) > 0) prefetchHits++;
+        if (slots[i].status == LOADED) {
+          subSlots.put(std::move(slots[i]));
+        } else {
+          // nothing worth caching, give the region of the empty/stale slot back
+          residency.release(slots[i].blockID, RESIDENT_SLOT, i);
+          arena.release(slots[i].region);
+        }
         slots[i] = std::move(extracted);
+        slots[i].requested = slots[i].count;
+        residency.set(blockID, RESIDENT_SLOT, i);
+        refineSlot(i);
         continue;
       }
     }
 
     // Not found
-    int count = std::min(blocks[i].count, num_points_per_slot);
-    loadBlock(blockID, i, count, true);
-    loadBlockCount++;
+    int count = ranked(i).lodCount;
+    if (!loadBlock(blockID, i, 0, count, true, (float)i)) {
+      // all staging regions in use, the block is requested (and counted) again next frame
+      continue;
+    }
     cacheMiss++;
+    assignSlot(i, blockID, count);
+    loadBlockCount++;
+  }
+  // jobs of earlier frames follow the new order, the ones nobody waits for are dropped
+  if (isAsync) {
+    rescheduleJobs();
   }
   // std::cout << "cacheMiss: " << cacheMiss << "  " << "limit: " << limit << " " << "visibleCount: " << visibleCount << "\n";
 
+  // hint the next blocks in line to the kernel, they are the most likely misses of the next frames
+  for (int i = limit; i < std::min<int>(limit + PREFETCH_HINTS, (int)blocks.size()); i++) {
+    dataManager.prefetchBlock(ranked(i).blockID, ranked(i).lodCount);
+  }
+
   // initialize cache and LRU update it
   if (isCache && !cacheInitialized){
+    bool complete = true;
     int i = 0;
     int blockIdx = limit;
     while (i < num_subSlots && blockIdx < (int)blocks.size()) {
-      int blockID = blocks[blockIdx].blockID;
+      int blockID = ranked(blockIdx).blockID;
       // if (isBlockInSlot(slots, blockID)) {
       //   blockIdx++;
       //   continue;
@@ -506,80 +871,482 @@ void Rasterizer::loadBlocksOOC(){
         blockIdx++;
         continue;
       }
+      // requested by an earlier, unfinished warm-up and still in flight
+      if (warmupPending.count(blockID) > 0) {
+        i++;
+        blockIdx++;
+        continue;
+      }
       // not in subSlots. load it.
-      int count = std::min(blocks[blockIdx].count, num_points_per_slot);
-      loadBlock(blockID, i, count, false);
+      int count = ranked(blockIdx).lodCount;
+      if (!loadBlock(blockID, i, 0, count, false, (float)blockIdx)) {
+        // out of staging regions, go on next frame
+        complete = false;
+        break;
+      }
+      warmupPending.insert(blockID);
       loadBlockCount++;
       i++;
       blockIdx++;
     }
-    cacheInitialized = true;
+    cacheInitialized = complete;
+  }
+
+  // blocks the camera is heading for
+  if (isPrefetch) {
+    prefetchPredicted();
+  }
+}
+
+/**
+ * @brief Load blocks that the predicted camera will see into subslots
+ *
+ * The camera is extrapolated prefetchFrames ahead from its recent motion, or
+ * read ahead on a replayed path. Blocks are culled against that frustum and
+ * the nearest ones, up to half of the subslots, are kept cached; missing ones
+ * are loaded with the lowest priority of the frame, at most PREDICT_MAX_JOBS
+ * per frame. Once they become visible they are cache hits, not misses.
+ */
+void Rasterizer::prefetchPredicted() {
+  Camera future = camera;
+  if (isReplay) {
+    if (cameraPath.size() == 0) return;
+    cameraPath.apply(std::min(cameraFrame + (size_t)prefetchFrames, cameraPath.size() - 1), future);
+  } else if (!predictor.predict(camera, (float)prefetchFrames, future)) {
+    return; // camera at rest, the current frustum is all there is
+  }
+  glm::mat4 futureView = future.GetViewMatrix();
+
+  culler.cull(proj, futureView, z_near, z_far, futureCull);
+
+  // blocks that are not drawn now but visible from the predicted pose, nearest first
+  std::vector<std::pair<float, int>> candidates;
+  for (int i = limit; i < (int)blocks.size(); i++) {
+    float dist = futureCull.planeDist[ranked(i).blockID];
+    if (dist < 0.0f) continue;
+    candidates.emplace_back(futureCull.cameraDist[ranked(i).blockID], i);
+    // soon visible, the cost-aware policy should keep it
+    if (!blockScore.empty()) blockScore[ranked(i).blockID] = std::max(blockScore[ranked(i).blockID], dist);
+  }
+  int keep = std::min<int>((int)candidates.size(), std::max(1, num_subSlots / 2));
+  std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end());
+
+  int issued = 0;
+  for (int k = 0; k < keep && issued < PREDICT_MAX_JOBS; k++) {
+    const Block& block = ranked(candidates[k].second);
+    int blockID = block.blockID;
+    if (residency.isResident(blockID) || prefetchPending.count(blockID) > 0) {
+      continue;
+    }
+    // behind every load and refinement of this frame
+    if (!loadBlock(blockID, -1, 0, block.lodCount, false, (float)(limit + (int)slots.size() + k))) {
+      break;
+    }
+    prefetchPending.insert(blockID);
+    loadBlockCount++;
+    prefetchLoads++;
+    issued++;
+  }
+}
+
+/**
+ * @brief Request the next points of a loaded slot if its LOD budget grew
+ *
+ * Only the missing part of the progressive order is loaded and appended
+ * behind the points already in the slot. One refinement per slot is in
+ * flight at a time; it ranks behind all misses of the frame.
+ */
+void Rasterizer::refineSlot(int slotIdx) {
+  Slot& slot = slots[slotIdx];
+  if ((!isLOD && !frameBudget.enabled()) || slot.status != LOADED || slot.requested != slot.count) return;
+
+  int need = ranked(slotIdx).lodCount;
+  int maxCount = std::min(ranked(slotIdx).count, num_points_per_slot);
+  if (need <= slot.count) return;
+  if (need < maxCount && (float)need < LOD_REFINE_STEP * (float)slot.count) return;
+
+  if (loadBlock(slot.blockID, slotIdx, slot.count, need - slot.count, true, (float)(limit + slotIdx))) {
+    slot.requested = need;
+    loadBlockCount++;
   }
 }
 
+/**
+ * @brief Re-key queued jobs to this frame's order and cancel stale ones
+ *
+ * A slot job stays alive while a visible slot (index < limit) is still
+ * loading its block; its priority becomes that slot index, i.e. the rank
+ * from sortBlocks. Refinements stay alive while their slot is visible and
+ * rank behind all loads. Cache warm-up jobs are always kept. Cancelled jobs come
+ * back as results without points and are handled in uploadResult.
+ */
+void Rasterizer::rescheduleJobs() {
+  auto refresh = [this](Job& job) {
+    if (!job.loadToSlots) {
+      job.generation = frameID;
+      return;
+    }
+    int idx = (job.first > 0) ? findRefiningSlot(job.blockID, job.slotIdx, job.first)
+                              : findLoadingSlot(job.blockID, job.slotIdx);
+    if (idx < 0 || idx >= limit) {
+      return; // no visible slot waits for it anymore
+    }
+    job.slotIdx = idx;
+    job.priority = (float)((job.first > 0) ? limit + idx : idx);
+    job.generation = frameID;
+  };
+  cancelledJobs += dataManager.rescheduleJobs(refresh, frameID);
+}
+
+/**
+ * @brief Hand a slot over to a new block and mark it as loading
+ *
+ * Loaded content is moved into the subslots cache first (if enabled), so the
+ * slot gets the arena region of the evicted subslot or a free one.
+ *
+ * @param slotIdx index of the slot to reuse
+ * @param blockID block that will be streamed into the slot
+ * @param count number of points requested for the block
+ */
+void Rasterizer::assignSlot(int slotIdx, int blockID, int count) {
+  Slot& slot = slots[slotIdx];
+  if (isCache && slot.status == LOADED) {
+    Slot evicted;
+    if (subSlots.put(std::move(slot), &evicted)) {
+      // Reuse evicted slot's region
+      prefetched.erase(evicted.blockID);
+      slot.region = evicted.region;
+    } else {
+      // Cache not full yet, take a free region
+      slot.region = arena.acquire();
+    }
+  }
+  // no-op if the old block went to the cache, its entry points at the subslot now
+  residency.release(slot.blockID, RESIDENT_SLOT, slotIdx);
+  residency.set(blockID, RESIDENT_SLOT, slotIdx);
+  slot.blockID = blockID;
+  slot.count = count;
+  slot.requested = count;
+  slot.status = LOADING;
+}
+
 /**
  * @brief Draw existing blocks already in slots. out-of-core mode.
+ *
+ * All of them go out in one multi-draw over the slot arena.
  */
 void Rasterizer::drawOldBlocksOOC()
 {
   for (int i = 0; i < limit; i++) {
-    if (slots[i].blockID != blocks[i].blockID) {
+    if (slots[i].blockID != ranked(i).blockID || slots[i].status != LOADED) {
       continue;
     }
-    glBindVertexArray(slots[i].vao);
-    glDrawArrays(GL_POINTS, 0, (GLsizei)slots[i].count);
+    // a far block draws a prefix of what is loaded, i.e. a uniform subsample
+    arena.addDraw(slots[i].region, std::min(slots[i].count, ranked(i).lodCount));
   }
+  arena.flushDraws();
 }
 
 /**
  * @brief Draw newly loaded blocks from worker threads. out-of-core mode.
+ *
+ * Blocking mode waits for every job of this frame. Async mode only drains
+ * results that are already available, within the per-frame upload budget;
+ * anything still in flight is picked up in a later frame.
  */
 void Rasterizer::drawLoadedBlocksOOC()
 {
+  if (isAsync) {
+    TimerCPU t;
+    size_t bytes = 0;
+    Result r;
+    while (inFlight > 0 && withinUploadBudget(bytes, t.ms()) && dataManager.tryGetResult(r)) {
+      bytes += (r.points != nullptr) ? (size_t)r.count * sizeof(PointQ) : 0;
+      uploadResult(r);
+      dataManager.releaseResult(r);
+      inFlight--;
+    }
+    arena.flushDraws();
+    return;
+  }
+
   int count = 0;
   while (count < loadBlockCount){
     Result r;
     dataManager.getResult(r);
+    uploadResult(r);
+    dataManager.releaseResult(r);
+    inFlight--;
+    count++;
+  }
+  arena.flushDraws();
+}
 
-    if (r.loadToSlots){
+/**
+ * @brief Check if the per-frame upload budget still allows another upload
+ * @param bytes bytes uploaded so far in this frame
+ * @param ms time spent uploading so far in this frame
+ */
+bool Rasterizer::withinUploadBudget(size_t bytes, float ms) const {
+  if (uploadBudgetBytes > 0 && bytes >= uploadBudgetBytes) return false;
+  if (uploadBudgetMs > 0.0f && ms >= uploadBudgetMs) return false;
+  return true;
+}
 
-      if (isCache){
-        Slot evicted;
-        if (subSlots.put(std::move(slots[r.slotIdx]), &evicted)) {
-          // Reuse evicted slot's VAO/VBO
-          slots[r.slotIdx].vao = evicted.vao;
-          slots[r.slotIdx].vbo = evicted.vbo;
-        } else {
-          // Cache not full yet, create new VAO/VBO
-          setupBuffer(slots[r.slotIdx].vao, slots[r.slotIdx].vbo, num_points_per_slot, sizeof(Point));
-        }
+/**
+ * @brief Upload a finished job into its slot or subslot
+ *
+ * Results whose slot has been handed to another block in the meantime are dropped.
+ */
+void Rasterizer::uploadResult(Result& r)
+{
+  if (r.points == nullptr) {
+    dropResult(r);
+    return;
+  }
+
+  if (r.loadToSlots && r.first > 0) {
+    // refinement: append behind the points already in the slot
+    int idx = findRefiningSlot(r.blockID, r.slotIdx, r.first);
+    if (idx < 0) {
+      discardResult(r);
+      return;
+    }
+    Slot& slot = slots[idx];
+    uploadPoints(slot.region, r);
+    slot.count = r.first + r.count;
+    slot.requested = std::max(slot.requested, slot.count);
+    if (idx < limit) {
+      arena.addDraw(slot.region, std::min(slot.count, ranked(idx).lodCount) - r.first, r.first);
+    }
+  } else if (r.loadToSlots){
+    int idx = findLoadingSlot(r.blockID, r.slotIdx);
+    if (idx < 0) {
+      discardResult(r);
+      return;
+    }
+    Slot& slot = slots[idx];
+    uploadPoints(slot.region, r);
+
+    slot.count = r.count;
+    slot.requested = r.count;
+    slot.status = LOADED;
+
+    // drawn with the rest of this frame's uploads
+    if (idx < limit) {
+      arena.addDraw(slot.region, r.count);
+    }
+  } else if (r.slotIdx == PROGRESSIVE_SLOT) {
+    uploadProgressive(r);
+  } else {
+    bool predicted = prefetchPending.erase(r.blockID) > 0;
+    warmupPending.erase(r.blockID);
+    // became visible and got loaded into a slot in the meantime
+    if (residency.isResident(r.blockID)) {
+      discardResult(r);
+      return;
+    }
+    // Cache initialization and prefetch path - take a free region, or the LRU subslot's
+    Slot s;
+    s.region = arena.acquire();
+    if (s.region < 0) {
+      Slot lru;
+      if (subSlots.evictSubslot(&lru) >= 0) {
+        prefetched.erase(lru.blockID);
+        s.region = lru.region;
       }
+    }
+    if (s.region < 0) {
+      discardResult(r);
+      return;
+    }
+    uploadPoints(s.region, r);
+
+    s.blockID = r.blockID;
+    s.count = r.count;
+    s.requested = r.count;
+    s.status = LOADED;
+    Slot evicted;
+    if (subSlots.put(std::move(s), &evicted)) {
+      prefetched.erase(evicted.blockID);
+      arena.release(evicted.region);
+    }
+    if (predicted) prefetched.insert(r.blockID);
+  }
+}
+
+/**
+ * @brief Copy the points of a result into an arena region and set its frame
+ *
+ * With the staging ring this is a GPU-side copy out of the persistently
+ * mapped region, fenced so the region is not reused before the copy ran.
+ */
+void Rasterizer::uploadPoints(int region, const Result& r)
+{
+  if (r.first == 0) {
+    const BlockEntry& e = dataManager.getBlockEntry(r.blockID);
+    arena.setFrame(region, e.bb_min, e.bb_max);
+  }
 
-      glBindVertexArray(slots[r.slotIdx].vao);
-      glBindBuffer(GL_ARRAY_BUFFER, slots[r.slotIdx].vbo);
+  GLsizeiptr bytes = (GLsizeiptr)r.count * sizeof(PointQ);
+  frameBytes += (uint64_t)bytes;
+  GLintptr dst = arena.byteOffset(region) + (GLintptr)r.first * sizeof(PointQ);
+  if (r.stagingIdx >= 0) {
+    glBindBuffer(GL_COPY_READ_BUFFER, stagingRing.buffer());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arena.vbo());
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, stagingRing.offset(r.stagingIdx), dst, bytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    stagingRing.release(r.stagingIdx);
+    return;
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, arena.vbo());
+  glBufferSubData(GL_ARRAY_BUFFER, dst, bytes, r.points);
+}
 
-      slots[r.slotIdx].blockID = r.blockID;
-      slots[r.slotIdx].count = r.count;
-      slots[r.slotIdx].status = LOADED;
+/**
+ * @brief Undo what a failed or cancelled job reserved
+ *
+ * The staging region goes back, a slot waiting for the block is left empty
+ * so the block is requested again, a refinement can be requested again.
+ */
+void Rasterizer::dropResult(const Result& r)
+{
+  discardResult(r);
+  if (r.loadToSlots && r.first > 0) {
+    int idx = findRefiningSlot(r.blockID, r.slotIdx, r.first);
+    if (idx >= 0) slots[idx].requested = slots[idx].count;
+  } else if (r.loadToSlots) {
+    int idx = findLoadingSlot(r.blockID, r.slotIdx);
+    if (idx >= 0) {
+      Slot& slot = slots[idx];
+      residency.release(slot.blockID, RESIDENT_SLOT, idx);
+      slot.blockID = -1;
+      slot.count = 0;
+      slot.status = EMPTY;
+    }
+  } else if (r.slotIdx == PROGRESSIVE_SLOT) {
+    progressivePending--;
+  } else {
+    prefetchPending.erase(r.blockID);
+    warmupPending.erase(r.blockID);
+  }
+}
 
-      glBufferSubData(GL_ARRAY_BUFFER, 0, r.count * sizeof(Point), r.points.data());
-      glDrawArrays(GL_POINTS, 0, (GLsizei)r.count);
-    } else {
-      // Cache initialization path - cache isn't full yet, create new VAO/VBO
-      Slot s;
-      setupBuffer(s.vao, s.vbo, num_points_per_slot, sizeof(Point));
+/**
+ * @brief Give the staging region of a dropped result back
+ */
+void Rasterizer::discardResult(const Result& r)
+{
+  if (r.stagingIdx >= 0) {
+    stagingRing.discard(r.stagingIdx);
+  }
+}
+
+/**
+ * @brief Draw what the frames before left out into the accumulated framebuffer
+ *
+ * Runs instead of the regular draws once the view is still and complete:
+ * the framebuffer is not cleared, so everything added lands on top of the
+ * last frame with the depth test sorting it out. In-core the points of the
+ * ranked blocks past their LOD budget come first, then the visible blocks
+ * past limit in rank order, progressiveBlocks per frame. Out-of-core those
+ * blocks are drawn from a slot or subslot if they are resident, otherwise
+ * streamed into the spare regions (see uploadProgressive()).
+ */
+void Rasterizer::drawProgressive() {
+  if (progressiveNext < 0) {
+    // the first still frame: rank the rest of the blocks, too
+    std::sort(ranking.begin() + rankCount, ranking.end(), [](const RankKey& a, const RankKey& b) { return a.key < b.key; });
+    rankCount = (int)ranking.size();
+    progressiveNext = limit;
+    progressiveLOD = 0;
+  }
 
-      glBindVertexArray(s.vao);
-      glBindBuffer(GL_ARRAY_BUFFER, s.vbo);
-      glBufferSubData(GL_ARRAY_BUFFER, 0, r.count * sizeof(Point), r.points.data());
+  int budget = progressiveBlocks;
+  if (!isOOC) {
+    auto draw = [this](const Block& b, int first, int count) {
+      setBlockFrame(b.bb_min, b.bb_max);
+      glBindVertexArray(b.vao);
+      glDrawArrays(GL_POINTS, (GLint)first, (GLsizei)count);
+    };
+    for (; budget > 0 && progressiveLOD < limit; progressiveLOD++) {
+      const Block& b = ranked(progressiveLOD);
+      if (!b.isVisible || b.lodCount >= b.count) continue;
+      draw(b, b.lodCount, b.count - b.lodCount);
+      budget--;
+    }
+    for (; budget > 0 && progressiveNext < visibleCount; progressiveNext++, budget--) {
+      const Block& b = ranked(progressiveNext);
+      draw(b, 0, b.count);
+    }
+    return;
+  }
 
-      s.blockID = r.blockID;
-      s.count = r.count;
-      s.status = LOADED;
-      subSlots.put(std::move(s));
+  for (; budget > 0 && progressiveNext < visibleCount; progressiveNext++, budget--) {
+    const Block& b = ranked(progressiveNext);
+    int s = residency.slot(b.blockID);
+    const Slot* cached = isCache ? subSlots.peek(b.blockID) : nullptr;
+    if (s >= 0 && slots[s].status == LOADED) {
+      arena.addDraw(slots[s].region, slots[s].count);
+    } else if (cached != nullptr) {
+      arena.addDraw(cached->region, cached->count);
+    } else {
+      // one spare region per job, so none of the results has to be dropped
+      if (progressivePending >= (int)progressiveFree.size()) break;
+      int count = std::min(b.count, num_points_per_slot);
+      if (!loadBlock(b.blockID, PROGRESSIVE_SLOT, 0, count, false, (float)(limit + (int)slots.size() + progressiveNext))) break;
+      progressivePending++;
+      loadBlockCount++;
     }
-    count++;
   }
+  arena.flushDraws();
+}
+
+/**
+ * @brief Upload a progressive result into a spare region and draw it
+ *
+ * The region is only needed until the draw went out, it is free again in
+ * the next frame. Results that arrive after the camera moved are dropped.
+ */
+void Rasterizer::uploadProgressive(Result& r) {
+  progressivePending--;
+  if (!accumulating || progressiveFree.empty()) {
+    discardResult(r);
+    return;
+  }
+  int region = progressiveFree.back();
+  progressiveFree.pop_back();
+  progressiveUsed.push_back(region);
+  uploadPoints(region, r);
+  arena.addDraw(region, r.count);
+}
+
+/**
+ * @brief Count the frames view and proj stayed the same
+ */
+void Rasterizer::updateStill() {
+  bool same = !viewDirty && view == lastView && proj == lastProj;
+  stillFrames = same ? stillFrames + 1 : 0;
+  lastView = view;
+  lastProj = proj;
+  viewDirty = false;
+
+  // one complete frame with the final culling, then accumulate on top of it
+  accumulating = isProgressive && stillFrames > settleFrames() + 1;
+  if (!accumulating) progressiveNext = -1;
+}
+
+/**
+ * @brief Still frames after which culling and sorting give the same result again
+ *
+ * Occlusion queries of a still view keep arriving until every block in the
+ * frustum had its turn, OCCLUSION_MAX_QUERIES per frame.
+ */
+int Rasterizer::settleFrames() const {
+  int frames = STILL_SETTLE_FRAMES;
+  if (isOcclusion) frames += ((int)blocks.size() + OCCLUSION_MAX_QUERIES - 1) / OCCLUSION_MAX_QUERIES;
+  return frames;
 }
 
 /**
@@ -588,47 +1355,79 @@ void Rasterizer::drawLoadedBlocksOOC()
 void Rasterizer::drawBlocks(){
   // instead of drawing all visible blocks, keep it to num_slots.
   for (int i = 0; i < limit; i++){
-    if (blocks[i].isVisible && blocks[i].count > 0){
-      int count = std::min(blocks[i].count, num_points_per_slot);
-      glBindVertexArray(blocks[i].vao);
-      // glBindBuffer(GL_ARRAY_BUFFER, blocks[i].vbo);
+    if (ranked(i).isVisible && ranked(i).count > 0){
+      int count = ranked(i).lodCount;
+      if (renderBackend == RENDER_COMPUTE) {
+        compute.drawBuffer(ranked(i).vbo, count, ranked(i).bb_min, ranked(i).bb_max);
+        continue;
+      }
+      setBlockFrame(ranked(i).bb_min, ranked(i).bb_max);
+      glBindVertexArray(ranked(i).vao);
+      // glBindBuffer(GL_ARRAY_BUFFER, ranked(i).vbo);
       glDrawArrays(GL_POINTS, 0, (GLsizei)count);
     }
   }
 }
 
+/**
+ * @brief Set the quantization frame of the block about to be drawn
+ */
+void Rasterizer::setBlockFrame(const glm::vec3& bb_min_, const glm::vec3& bb_max_) {
+  glUniform3fv(locBlockMin, 1, &bb_min_[0]);
+  glm::vec3 extent = bb_max_ - bb_min_;
+  glUniform3fv(locBlockExtent, 1, &extent[0]);
+}
+
 /**
  * @brief find the block by ID in slots and keep it in the targetIdx by swap.
  * @param blockID: ID to search for in slots
  * @param slotIdx: The specific index in slotsTarget to perform the swap.
  */
 bool Rasterizer::updateSlotByBlockID(int blockID, int targetIdx) {
+  int i = residency.slot(blockID);
+  if (i < 0) {
+    // block not found.
+    return false;
+  }
+  if (i != targetIdx) {
+    std::swap(slots[i], slots[targetIdx]);
+    residency.set(slots[i].blockID, RESIDENT_SLOT, i);
+    residency.set(blockID, RESIDENT_SLOT, targetIdx);
+  }
+  return true;
+}
 
-  // stay with linear search.
-  for (int i = 0; i < slots.size(); i++) {
-    if (slots[i].blockID == blockID) {
-      std::swap(slots[i], slots[targetIdx]);
-      return true;
-    }
+/**
+ * @brief Find the slot that is waiting for the given block
+ * @param blockID block the result belongs to
+ * @param hintIdx slot index the job was issued for, checked first
+ * @return slot index, or -1 if no slot is loading this block anymore
+ */
+int Rasterizer::findLoadingSlot(int blockID, int hintIdx) {
+  if (hintIdx >= 0 && hintIdx < (int)slots.size() &&
+      slots[hintIdx].blockID == blockID && slots[hintIdx].status == LOADING) {
+    return hintIdx;
   }
-  // block not found.
-  return false;
+  int i = residency.slot(blockID);
+  return (i >= 0 && slots[i].status == LOADING) ? i : -1;
 }
 
 /**
- * @brief returns true if the block is in slots
- *
- * @param blockID: blockID to search in slots
- * @return
+ * @brief Find the loaded slot of a block whose uploaded points end at first
+ * @param blockID block the refinement belongs to
+ * @param hintIdx slot index the job was issued for, checked first
+ * @param first index of the first point of the refinement
+ * @return slot index, or -1 if the slot was handed over or moved away
  */
-bool Rasterizer::isBlockInSlot(int blockID) {
-  for (int i = 0; i < slots.size(); i++) {
-    if (blockID == slots[i].blockID) {
-      std::cout << "isBlockInSlot returns True" << std::endl;
-      return true;
-    }
+int Rasterizer::findRefiningSlot(int blockID, int hintIdx, int first) {
+  auto matches = [&](const Slot& s) {
+    return s.blockID == blockID && s.status == LOADED && s.count == first;
+  };
+  if (hintIdx >= 0 && hintIdx < (int)slots.size() && matches(slots[hintIdx])) {
+    return hintIdx;
   }
-  return false;
+  int i = residency.slot(blockID);
+  return (i >= 0 && matches(slots[i])) ? i : -1;
 }
 
 
@@ -637,12 +1436,18 @@ bool Rasterizer::isBlockInSlot(int blockID) {
  * @brief Set orbital camera pose for test mode
  */
 void Rasterizer::setCameraPose(){
-  if (!isTest) return;
-  // test mode: orbit camera around scene center
-  float theta = angularSpeed * (fixedDt);
-  dir = camera_position - center;
-  camera_position = center + (Rz(theta) * dir);
-  camera.changePose(camera_position, center);
+  if (isReplay) {
+    // one recorded pose per frame, independent of the frame time
+    cameraPath.apply(cameraFrame++, camera);
+  } else if (isTest) {
+    // test mode: orbit camera around scene center
+    float theta = angularSpeed * (fixedDt);
+    dir = camera_position - center;
+    camera_position = center + (Rz(theta) * dir);
+    camera.changePose(camera_position, center);
+  }
+  if (!cameraRecordPath.empty()) recordedPath.record(camera);
+  if (isPrefetch) predictor.observe(camera);
 }
 
 /**
@@ -653,55 +1458,109 @@ void Rasterizer::render(){
   while (!glfwWindowShouldClose(window)) {
 
     {
-      CPU_PROFILE(profilerCPU, "Frame");
+      PROFILE(profilerCPU, profilerGPU, Section::Frame);
 
       {
-        CPU_PROFILE(profilerCPU, "work1");
+        PROFILE(profilerCPU, profilerGPU, Section::Work1);
         processInput();
-        setCameraPose(); // test mode
-        clear();
+        setCameraPose(); // replay or test mode
         setShaderView();
+        updateStill();
+        if (!accumulating) clear();
       }
 
-
-      { CPU_PROFILE(profilerCPU, "cullBlocks"); cullBlocks(); }
-      { CPU_PROFILE(profilerCPU, "sortBlocks"); sortBlocks(); }
+      // a still camera sees the same blocks in the same order as the frame before
+      bool recull = stillFrames <= settleFrames();
+      if (recull) {
+        { PROFILE(profilerCPU, profilerGPU, Section::CullBlocks); cullBlocks(); }
+        { PROFILE(profilerCPU, profilerGPU, Section::SortBlocks); sortBlocks(); }
+      }
 
       if (isOOC) {
-        { CPU_PROFILE(profilerCPU, "LoadOOC"); loadBlocksOOC(); }
-        { CPU_PROFILE(profilerCPU, "drawOldBlocksOOC"); drawOldBlocksOOC(); }
-        { CPU_PROFILE(profilerCPU, "drawLoadedBlocksOOC"); drawLoadedBlocksOOC(); }
+        { PROFILE(profilerCPU, profilerGPU, Section::LoadOOC); loadBlocksOOC(); }
+        if (accumulating) {
+          // the slots are in the framebuffer already
+          PROFILE(profilerCPU, profilerGPU, Section::Progressive);
+          drawProgressive();
+        } else {
+          PROFILE(profilerCPU, profilerGPU, Section::DrawOldBlocksOOC);
+          drawOldBlocksOOC();
+        }
+        { PROFILE(profilerCPU, profilerGPU, Section::DrawLoadedBlocksOOC); drawLoadedBlocksOOC(); }
+        // the spare regions were drawn from, the next uploads are ordered behind those draws
+        progressiveFree.insert(progressiveFree.end(), progressiveUsed.begin(), progressiveUsed.end());
+        progressiveUsed.clear();
+      } else if (accumulating) {
+        PROFILE(profilerCPU, profilerGPU, Section::Progressive);
+        drawProgressive();
       } else {
-        { CPU_PROFILE(profilerCPU, "DrawInCore"); drawBlocks(); }
+        PROFILE(profilerCPU, profilerGPU, Section::DrawInCore);
+        drawBlocks();
+      }
+
+      // compute backend: points so far are in its framebuffer, copy them out
+      if (renderBackend == RENDER_COMPUTE) {
+        compute.resolve();
+        shader->use();
+      }
+
+      // boxes against the depth of this frame, read back in a later frame
+      if (isOcclusion && recull) {
+        PROFILE(profilerCPU, profilerGPU, Section::Occlusion);
+        occlusion.issue(blocks, cullOut, view, proj, camera.Position, z_near);
       }
 
       // export before swap to capture current back buffer
       exportFrame();
 
       {
-        CPU_PROFILE(profilerCPU, "work2");
+        PROFILE(profilerCPU, profilerGPU, Section::Work2);
         // Swap buffers & poll events
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        if (isHeadless) {
+          presentHeadless();
+        } else {
+          if (offscreenFBO != 0) presentOffscreen();
+          glfwSwapBuffers(window);
+          glfwPollEvents();
+        }
       }
     }
 
+    profilerGPU.end_frame();
+
+    // adapt slots and points to this frame's time; a still view being refined has no target
+    if (frameBudget.enabled() && !accumulating &&
+        frameBudget.update(profilerCPU.stat(Section::Frame).current_ms)) {
+      viewDirty = true; // cull and rank again with the new budgets
+    }
+
     // update Benchmarks
     updateBenchmarks();
 
     // break?
-    if (profilerCPU.stats["Frame"].calls - warmup + 1 >= N) {
+    if (profilerCPU.stat(Section::Frame).calls - warmup + 1 >= N || (isReplay && cameraFrame >= cameraPath.size())) {
       glfwSetWindowShouldClose(window, true);
       break;
     }
   }
 
+  if (!cameraRecordPath.empty()) recordedPath.save(cameraRecordPath);
+  if (isExport) {
+    exporter.finish();
+    std::cout << "Exported " << exporter.framesQueued() << " frames." << std::endl;
+  }
+
   // print stats
   printStats();
-  profilerCPU.end_frame_and_print();
+  profilerGPU.flush();
+  if (profilerGPU.droppedFrames > 0) {
+    std::cout << "GPU profiler dropped " << profilerGPU.droppedFrames << " frames (GPU more than " << GPU_QUERY_FRAMES << " frames behind)." << std::endl;
+  }
 
-  // quit
+  // quit, the workers must be done before their stats are merged
   if (isOOC) dataManager.quit();
+  profilerCPU.end_frame_and_print(12, &profilerGPU.stats);
+  if (!tracePath.empty()) profilerCPU.write_trace(tracePath);
 }
 
 /**
@@ -712,8 +1571,8 @@ void Rasterizer::processInput() {
   // check if ESC pressed
   if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) glfwSetWindowShouldClose(window, true);
 
-  // test mode
-  if (isTest) return;
+  // test mode, replay
+  if (isTest || isReplay) return;
 
   // keys (continuous)
   if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) camera.ProcessKeyboard(Camera::FORWARD, fixedDt);
@@ -807,49 +1666,47 @@ void Rasterizer::handleMouseMove(GLFWwindow* window, double xposIn, double yposI
  * @brief GLFW framebuffer size callback
  */
 void Rasterizer::framebuffer_size_callback(GLFWwindow *window, int width, int height) {
+  // the offscreen framebuffer keeps its size, presentOffscreen() scales it
+  auto* self = static_cast<Rasterizer*>(glfwGetWindowUserPointer(window));
+  if (self != nullptr && self->offscreenFBO != 0) return;
   // make sure the viewport matches the new window dimensions; note that width
   // and height will be significantly larger than specified on retina displays.
   glViewport(0, 0, width, height);
 }
 
-void Rasterizer::saveFramePNG(const std::string& path, int w, int h) {
-  std::vector<unsigned char> rgba(w * h * 4);
-
-  glPixelStorei(GL_PACK_ALIGNMENT, 1);
-  glReadBuffer(GL_BACK); // capture what you're about to swap
-  glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
-
-  // Flip vertically (OpenGL origin is bottom-left)
-  for (int y = 0; y < h / 2; ++y) {
-    int top = y * w * 4;
-    int bot = (h - 1 - y) * w * 4;
-    for (int x = 0; x < w * 4; ++x) std::swap(rgba[top + x], rgba[bot + x]);
-  }
-
-  stbi_write_png(path.c_str(), w, h, 4, rgba.data(), w * 4);
+/**
+ * @brief Start the PBO readback and the writers if export mode enabled
+ */
+bool Rasterizer::setupExport() {
+  if (!isExport) return true;
+  int w = 0, h = 0;
+  framebufferSize(w, h);
+  if (!exporter.init(w, h, exportDir, exportFormat, exportWriters, offscreenFBO != 0 ? GL_COLOR_ATTACHMENT0 : GL_BACK)) return false;
+  std::cout << "Exporting " << w << "x" << h << " " << exportFormatName(exportFormat) << " frames to " << exportDir << std::endl;
+  return true;
 }
 
 /**
  * @brief Export current frame if export mode enabled
+ *
+ * Only starts the readback, the frame is written a few frames later by the
+ * writer threads of the exporter.
  */
 void Rasterizer::exportFrame() {
   if (!isExport) return;
-  char buf[256];
-  std::snprintf(buf, sizeof(buf), "%s/frame_%05d.png", "../outputs", profilerCPU.stats["Frame"].calls);
-  saveFramePNG(buf, window_width, window_height);
+  exporter.capture(profilerCPU.stat(Section::Frame).calls);
 }
 
 /**
  * @brief Update benchmark statistics per frame
  */
 void Rasterizer::updateBenchmarks() {
-  if (profilerCPU.stats["Frame"].calls < warmup) return;
-  float dt = profilerCPU.stats["Frame"].current_ms;
+  uint64_t bytes = frameBytes;
+  frameBytes = 0;
+  if (profilerCPU.stat(Section::Frame).calls < warmup) return;
+  float dt = profilerCPU.stat(Section::Frame).current_ms;
   float fps = (dt > 0.0f) ? (1000.0f / dt) : 0.0f;
-  maxVisibleCount = std::max(maxVisibleCount, visibleCount);
-  minVisibleCount = std::min(minVisibleCount, visibleCount);
-  maxCacheMiss = std::max(maxCacheMiss, cacheMiss);
-  minCacheMiss = std::min(minCacheMiss, cacheMiss);
+  bench.frames.push_back({ dt, visibleCount, cacheMiss, bytes, occludedCount });
   updateWindowTitle(fps);
 }
 
@@ -857,7 +1714,8 @@ void Rasterizer::updateBenchmarks() {
  * @brief Update window title with FPS info
  */
 void Rasterizer::updateWindowTitle(float fps) {
-  if (profilerCPU.stats["cullBlocks"].calls % 10 != 1) return;
+  if (isHeadless) return;
+  if (profilerCPU.stat(Section::Frame).calls % 10 != 1) return;
   char buf[128];
   std::snprintf(buf, sizeof(buf),
       "MyRasterizer | FPS: %.1f | visibleCount: %d | Cache Miss: %d", fps, visibleCount, cacheMiss);
@@ -868,16 +1726,68 @@ void Rasterizer::updateWindowTitle(float fps) {
  * @brief Print benchmark results to stdout
  */
 void Rasterizer::printStats() {
-  auto& frameStat = profilerCPU.stats["Frame"];
-  avgFPS = 1000.0f * frameStat.calls / frameStat.total_ms;
-  maxFPS = 1000.0f / frameStat.min_ms;
-  minFPS = 1000.0f / frameStat.max_ms;
+  // frames after warmup only
+  float total_ms = 0.0f;
+  float min_ms = FLT_MAX;
+  float max_ms = 0.0f;
+  bench.maxVisibleCount = bench.maxCacheMiss = bench.maxOccluded = 0;
+  bench.minVisibleCount = bench.minCacheMiss = INT_MAX;
+  bench.bytesStreamed = 0;
+  for (const FrameRecord& f : bench.frames) {
+    total_ms += f.ms;
+    min_ms = std::min(min_ms, f.ms);
+    max_ms = std::max(max_ms, f.ms);
+    bench.maxVisibleCount = std::max(bench.maxVisibleCount, f.visibleCount);
+    bench.minVisibleCount = std::min(bench.minVisibleCount, f.visibleCount);
+    bench.maxCacheMiss = std::max(bench.maxCacheMiss, f.cacheMiss);
+    bench.maxOccluded = std::max(bench.maxOccluded, f.occluded);
+    bench.minCacheMiss = std::min(bench.minCacheMiss, f.cacheMiss);
+    bench.bytesStreamed += f.bytesStreamed;
+  }
+  if (bench.frames.empty()) {
+    min_ms = 0.0f;
+    bench.minVisibleCount = bench.minCacheMiss = 0;
+  }
+  bench.avgFPS = total_ms > 0.0f ? 1000.0 * bench.frames.size() / total_ms : 0.0;
+  bench.maxFPS = min_ms > 0.0f ? 1000.0 / min_ms : 0.0;
+  bench.minFPS = max_ms > 0.0f ? 1000.0 / max_ms : 0.0;
+  bench.p50_ms = bench.framePercentile(0.50f);
+  bench.p95_ms = bench.framePercentile(0.95f);
+  bench.p99_ms = bench.framePercentile(0.99f);
+  bench.prefetchLoads = prefetchLoads;
+  bench.prefetchHits = prefetchHits;
+  bench.cacheHits = subSlots.stats().hits;
+  bench.cacheMisses = subSlots.stats().misses;
+  bench.cacheInserts = subSlots.stats().inserts;
+  bench.cacheEvictions = subSlots.stats().evictions;
+  bench.maxInFlight = maxInFlight;
+  bench.cancelledJobs = cancelledJobs;
+  bench.numBlocks = (int)blocks.size();
+  bench.numSlots = isOOC ? num_slots : 0;
+  bench.numSubSlots = (isOOC && isCache) ? num_subSlots : 0;
+
   std::cout << "Bench N=" << N << " warmup= " << warmup << "\n";
-  std::cout << "Avg FPS: " << avgFPS << "\n";
-  std::cout << "Max FPS: " << maxFPS << "\n";
-  std::cout << "Min FPS: " << minFPS << "\n";
-  std::cout << "Max visibleCount: " << maxVisibleCount << "\n";
-  std::cout << "Min visibleCount: " << minVisibleCount << "\n";
-  std::cout << "Max cacheMiss: " << maxCacheMiss << "\n";
-  std::cout << "Min cacheMiss: " << minCacheMiss << "\n";
+  std::cout << "Avg FPS: " << bench.avgFPS << "\n";
+  std::cout << "Max FPS: " << bench.maxFPS << "\n";
+  std::cout << "Min FPS: " << bench.minFPS << "\n";
+  std::cout << "Frame time p50/p95/p99 (ms): " << bench.p50_ms << " / "
+            << bench.p95_ms << " / " << bench.p99_ms << "\n";
+  std::cout << "Max visibleCount: " << bench.maxVisibleCount << "\n";
+  std::cout << "Min visibleCount: " << bench.minVisibleCount << "\n";
+  std::cout << "Max cacheMiss: " << bench.maxCacheMiss << "\n";
+  std::cout << "Min cacheMiss: " << bench.minCacheMiss << "\n";
+  if (isOOC) std::cout << "Streamed: " << bench.bytesStreamed / (1024.0 * 1024.0) << " MB\n";
+  if (isOOC) std::cout << "Max in-flight jobs: " << maxInFlight << "\n";
+  if (isOOC) std::cout << "Cancelled jobs: " << cancelledJobs << "\n";
+  if (isOOC && isCache) {
+    std::cout << "Cache (" << cachePolicyName(cachePolicy) << ") hits / misses / evictions: "
+              << bench.cacheHits << " / " << bench.cacheMisses << " / " << bench.cacheEvictions << "\n";
+  }
+  if (isOcclusion) std::cout << "Max occluded blocks: " << bench.maxOccluded << "\n";
+  if (isPrefetch) std::cout << "Prefetch loads / hits: " << prefetchLoads << " / " << prefetchHits << "\n";
+  if (frameBudget.enabled()) {
+    std::cout << "Frame time budget: " << frameBudget.slots() << " / " << frameBudget.maxSlots()
+              << " slots, " << (int)(100.0f * frameBudget.pointScale()) << "% points, smoothed "
+              << frameBudget.smoothedMs() << " ms\n";
+  }
 }
@@ -0,0 +1,156 @@
+//=============================================================================
+//
+//   SlotArena - One shared vertex buffer for all slots and subslots
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "SlotArena.h"
+#include "GLExt.h"
+#include "Point.h"
+#include "ComputeRasterizer.h"
+#include <iostream>
+
+/**
+ * @brief Allocate the arena, the region frames and the draw buffers
+ * @param numRegions_ number of regions (slots + subslots)
+ * @param pointsPerRegion_ capacity of one region in points
+ * @param pointSize size of one vertex in bytes
+ */
+bool SlotArena::init(int numRegions_, int pointsPerRegion_, size_t pointSize) {
+  numRegions = numRegions_;
+  pointsPerRegion = pointsPerRegion_;
+  stride = pointSize;
+
+  GLsizeiptr bytes = (GLsizeiptr)numRegions * pointsPerRegion * (GLsizeiptr)stride;
+  glGenVertexArrays(1, &arenaVAO);
+  glGenBuffers(1, &arenaVBO);
+  glBindVertexArray(arenaVAO);
+  glBindBuffer(GL_ARRAY_BUFFER, arenaVBO);
+  glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+  if (glGetError() == GL_OUT_OF_MEMORY) {
+    std::cerr << "Error: Could not allocate slot arena of " << bytes << " bytes." << std::endl;
+    glBindVertexArray(0);
+    destroy();
+    return false;
+  }
+
+  // attrib 0: quantized position (3 x uint16, normalized to [0,1] within the block bbox)
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, (GLsizei)stride, (void*)offsetof(PointQ, x));
+
+  // attrib 1: color (RGBA8, normalized)
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, (GLsizei)stride, (void*)offsetof(PointQ, r));
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // per-region quantization frames, read in the vertex shader
+  glGenBuffers(1, &frameBuf);
+  glBindBuffer(GL_TEXTURE_BUFFER, frameBuf);
+  glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)numRegions * 2 * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+  glGenTextures(1, &frameTex);
+  glBindTexture(GL_TEXTURE_BUFFER, frameTex);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, frameBuf);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+  if (glCaps.multiDrawIndirect) {
+    glGenBuffers(1, &indirectBuf);
+  }
+
+  freeRegions.clear();
+  for (int i = numRegions - 1; i >= 0; --i) freeRegions.push_back(i);
+  drawFirst.reserve(numRegions);
+  drawCount.reserve(numRegions);
+  return true;
+}
+
+/**
+ * @brief Delete all GL objects
+ */
+void SlotArena::destroy() {
+  if (arenaVAO != 0) glDeleteVertexArrays(1, &arenaVAO);
+  if (arenaVBO != 0) glDeleteBuffers(1, &arenaVBO);
+  if (frameTex != 0) glDeleteTextures(1, &frameTex);
+  if (frameBuf != 0) glDeleteBuffers(1, &frameBuf);
+  if (indirectBuf != 0) glDeleteBuffers(1, &indirectBuf);
+  arenaVAO = arenaVBO = frameTex = frameBuf = indirectBuf = 0;
+  freeRegions.clear();
+  drawFirst.clear();
+  drawCount.clear();
+}
+
+/**
+ * @brief Take a free region, -1 if none is left
+ */
+int SlotArena::acquire() {
+  if (freeRegions.empty()) return -1;
+  int region = freeRegions.back();
+  freeRegions.pop_back();
+  return region;
+}
+
+/**
+ * @brief Give a region back
+ */
+void SlotArena::release(int region) {
+  if (region >= 0) freeRegions.push_back(region);
+}
+
+/**
+ * @brief Store the quantization frame of the block held by a region
+ */
+void SlotArena::setFrame(int region, const glm::vec3& bb_min, const glm::vec3& bb_max) {
+  glm::vec4 frame[2] = { glm::vec4(bb_min, 0.0f), glm::vec4(bb_max - bb_min, 0.0f) };
+  glBindBuffer(GL_TEXTURE_BUFFER, frameBuf);
+  glBufferSubData(GL_TEXTURE_BUFFER, (GLintptr)region * sizeof(frame), sizeof(frame), frame);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+/**
+ * @brief Queue a draw of count points of a region, starting at point start
+ */
+void SlotArena::addDraw(int region, int count, int start) {
+  if (region < 0 || count <= 0) return;
+  drawFirst.push_back(first(region) + start);
+  drawCount.push_back((GLsizei)count);
+}
+
+/**
+ * @brief Issue all queued draws in one call and clear the list
+ *
+ * Uses glMultiDrawArraysIndirect when the context has it, glMultiDrawArrays otherwise,
+ * or the compute backend if one is set.
+ */
+void SlotArena::flushDraws() {
+  if (drawFirst.empty()) return;
+  GLsizei n = (GLsizei)drawFirst.size();
+
+  if (compute != nullptr) {
+    compute->drawRegions(arenaVBO, pointsPerRegion, drawFirst, drawCount);
+    drawFirst.clear();
+    drawCount.clear();
+    return;
+  }
+
+  glBindVertexArray(arenaVAO);
+  if (indirectBuf != 0) {
+    std::vector<DrawArraysIndirectCommand> cmds(n);
+    for (GLsizei i = 0; i < n; i++) {
+      cmds[i] = { (GLuint)drawCount[i], 1u, (GLuint)drawFirst[i], 0u };
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuf);
+    // orphan the previous batch, the GPU may still be reading it
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, n * sizeof(DrawArraysIndirectCommand), cmds.data(), GL_STREAM_DRAW);
+    glMultiDrawArraysIndirect(GL_POINTS, nullptr, n, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  } else {
+    glMultiDrawArrays(GL_POINTS, drawFirst.data(), drawCount.data(), n);
+  }
+
+  drawFirst.clear();
+  drawCount.clear();
+}
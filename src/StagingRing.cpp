@@ -0,0 +1,103 @@
+//=============================================================================
+//
+//   StagingRing - Persistently mapped, fence-guarded upload staging buffer
+//
+//   Copyright (C) 2026 Hyovin Kwak
+//
+//=============================================================================
+
+#include "StagingRing.h"
+#include "GLExt.h"
+#include <iostream>
+
+/**
+ * @brief Create and map the staging buffer
+ */
+bool StagingRing::init(size_t regionBytes_, int numRegions) {
+  if (!glCaps.bufferStorage) {
+    return false;
+  }
+  regionBytes = regionBytes_;
+  size_t bytes = regionBytes * (size_t)numRegions;
+
+  GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  glGenBuffers(1, &buf);
+  glBindBuffer(GL_COPY_READ_BUFFER, buf);
+  glBufferStorage(GL_COPY_READ_BUFFER, (GLsizeiptr)bytes, nullptr, flags);
+  mapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, (GLsizeiptr)bytes, flags));
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  if (mapped == nullptr) {
+    std::cerr << "Warning: Could not map staging buffer, using glBufferSubData uploads." << std::endl;
+    glDeleteBuffers(1, &buf);
+    buf = 0;
+    return false;
+  }
+
+  fences.assign(numRegions, nullptr);
+  freeRegions.clear();
+  pending.clear();
+  for (int i = numRegions - 1; i >= 0; --i) freeRegions.push_back(i);
+  return true;
+}
+
+/**
+ * @brief Unmap and delete the buffer
+ */
+void StagingRing::destroy() {
+  for (GLsync& f : fences) {
+    if (f != nullptr) glDeleteSync(f);
+    f = nullptr;
+  }
+  if (buf != 0) {
+    if (mapped != nullptr) {
+      glBindBuffer(GL_COPY_READ_BUFFER, buf);
+      glUnmapBuffer(GL_COPY_READ_BUFFER);
+      glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &buf);
+  }
+  buf = 0;
+  mapped = nullptr;
+  freeRegions.clear();
+  pending.clear();
+}
+
+/**
+ * @brief Get a free region index without blocking
+ *
+ * Regions whose fence has signaled since the last call go back to the free list first.
+ */
+int StagingRing::acquire() {
+  for (size_t k = 0; k < pending.size();) {
+    int idx = pending[k];
+    GLenum res = glClientWaitSync(fences[idx], 0, 0);
+    if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED) {
+      glDeleteSync(fences[idx]);
+      fences[idx] = nullptr;
+      freeRegions.push_back(idx);
+      pending[k] = pending.back();
+      pending.pop_back();
+    } else {
+      k++;
+    }
+  }
+  if (freeRegions.empty()) return -1;
+  int idx = freeRegions.back();
+  freeRegions.pop_back();
+  return idx;
+}
+
+/**
+ * @brief Return a region whose data was copied
+ */
+void StagingRing::release(int idx) {
+  fences[idx] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  pending.push_back(idx);
+}
+
+/**
+ * @brief Return a region that was never read by the GPU
+ */
+void StagingRing::discard(int idx) {
+  freeRegions.push_back(idx);
+}
@@ -1,19 +1,31 @@
 //=============================================================================
 //
-//   SubslotsCache - LRU cache for out-of-core block management
+//   SubslotsCache - Cache of evicted slots for out-of-core block management
 //
 //   Copyright (C) 2026 Hyovin Kwak
 //
 //=============================================================================
 
 #include "SubslotsCache.h"
-#include <glad/glad.h>
+#include <iostream>
 
 /**
- * @brief Initialize cache with given capacity
+ * @brief Initialize cache with given capacity and replacement policy
  */
-bool SubslotsCache::init(int size){
-  capacity = size;
+bool SubslotsCache::init(int size, ResidencyTable* residency_, CachePolicy policy_, const std::vector<float>* scores){
+  if (residency_ == nullptr) {
+    std::cerr << "Error: SubslotsCache needs a residency table." << std::endl;
+    return false;
+  }
+  capacity = size > 0 ? (size_t)size : 0;
+  count = 0;
+  residency = residency_;
+  entries.assign(capacity, Slot());
+  freeHandles.resize(capacity);
+  // handle 0 is handed out first
+  for (size_t i = 0; i < capacity; i++) freeHandles[i] = (int)(capacity - 1 - i);
+  policy = EvictionPolicy::create(policy_, capacity, scores);
+  counters = CacheStats();
   return true;
 }
 
@@ -21,12 +33,9 @@ bool SubslotsCache::init(int size){
  * @brief Mark block as recently used
  */
 bool SubslotsCache::touch(int blockID) {
-  auto it = where.find(blockID);
-  if (it == where.end())
+  if (!contains(blockID))
     return false;
-
-  // Move that node to the end in O(1)
-  slots.splice(slots.end(), slots, it->second);
+  policy->touch(blockID);
   return true;
 }
 
@@ -37,42 +46,55 @@ bool SubslotsCache::touch(int blockID) {
  * @return true if a slot was evicted, false otherwise
  */
 bool SubslotsCache::put(Slot s, Slot* evicted) {
-  auto it = where.find(s.blockID);
+  int handle = residency->subslot(s.blockID);
 
-  if (it != where.end()) {
-    // Update existing entry, move to MRU
-    *(it->second) = std::move(s);
-    slots.splice(slots.end(), slots, it->second);
+  if (handle >= 0) {
+    // Update existing entry, counts as a use
+    entries[handle] = std::move(s);
+    policy->touch(entries[handle].blockID);
     return false;
   }
 
   // Check if we need to evict before adding
-  bool willEvict = (slots.size() >= capacity);
-
-  if (willEvict) {
-    // Extract LRU slot before evicting
-    if (evicted) {
-      *evicted = std::move(slots.front());
+  bool willEvict = false;
+  if (count >= capacity) {
+    if (capacity == 0 || evict(evicted) < 0) {
+      // nothing fits or the policy has no victim, the slot goes straight back out
+      if (evicted) *evicted = std::move(s);
+      return true;
     }
-    where.erase(slots.front().blockID);
-    slots.pop_front();
+    willEvict = true;
   }
 
-  // Add new item at MRU position
-  slots.push_back(std::move(s));
-  auto nodeIt = std::prev(slots.end());
-  where[nodeIt->blockID] = nodeIt;
-
+  int blockID = s.blockID;
+  handle = freeHandles.back();
+  freeHandles.pop_back();
+  entries[handle] = std::move(s);
+  count++;
+  residency->set(blockID, RESIDENT_SUBSLOT, handle);
+  policy->insert(blockID);
+  counters.inserts++;
   return willEvict;
 }
 
 /**
- * @brief Evict the least recently used slot
+ * @brief Evict the slot chosen by the policy
+ */
+int SubslotsCache::evictSubslot(Slot* evicted) {
+  return evict(evicted);
+}
+
+/**
+ * @brief Remove the policy's victim, optionally handing it out
+ * @return blockID of the evicted slot, -1 if the cache is empty
  */
-int SubslotsCache::evictSubslot() {
-  int evictID = slots.front().blockID;
-  slots.pop_front();
-  where.erase(evictID);
+int SubslotsCache::evict(Slot* evicted) {
+  int evictID = policy->victim();
+  int handle = residency->subslot(evictID);
+  if (handle < 0) return -1;
+  take(handle, evicted);
+  policy->erase(evictID, false);
+  counters.evictions++;
   return evictID;
 }
 
@@ -80,27 +102,39 @@ int SubslotsCache::evictSubslot() {
  * @brief Extract a slot by blockID, removing it from cache
  */
 bool SubslotsCache::extract(int blockID, Slot& out) {
-  auto it = where.find(blockID);
-  if (it == where.end())
+  int handle = residency ? residency->subslot(blockID) : -1;
+  if (handle < 0) {
+    counters.misses++;
     return false;
+  }
 
   // Move the slot data out
-  out = std::move(*(it->second));
-
-  // Remove from list and map
-  slots.erase(it->second);
-  where.erase(it);
+  take(handle, &out);
+  policy->erase(blockID, true);
+  counters.hits++;
   return true;
 }
 
 /**
- * @brief Clear cache, deleting all VAO/VBO resources
+ * @brief Move the slot out of a handle and free it
+ */
+void SubslotsCache::take(int handle, Slot* out) {
+  Slot& s = entries[handle];
+  residency->release(s.blockID, RESIDENT_SUBSLOT, handle);
+  if (out) {
+    *out = std::move(s);
+  }
+  s = Slot();
+  freeHandles.push_back(handle);
+  count--;
+}
+
+/**
+ * @brief Clear cache (the slot arena owns the buffer memory)
  */
 void SubslotsCache::clear() {
-  for (auto& slot : slots) {
-    if (slot.vao != 0) glDeleteVertexArrays(1, &slot.vao);
-    if (slot.vbo != 0) glDeleteBuffers(1, &slot.vbo);
+  for (size_t h = 0; h < entries.size(); h++) {
+    if (entries[h].blockID >= 0) take((int)h, nullptr);
   }
-  slots.clear();
-  where.clear();
+  if (policy) policy->clear();
 }
@@ -7,7 +7,9 @@
 //=============================================================================
 
 #include "Rasterizer.h"
+#include "Benchmark.h"
 #include <string>
+#include <iostream>
 
 /**
  * @brief Check if string ends with given suffix
@@ -19,56 +21,239 @@ bool ends_with(const std::string& s, const std::string& suffix) {
 /**
  * @brief Application entry point
  * @param argc Argument count
- * @param argv Arguments: [ply file] [--test] [--ooc] [--cache] [--export]
+ * @param argv Arguments: [ply file] [--test] [--headless] [--ooc] [--cache] [--cache-policy lru|2q|cost] [--async] [--rebuild] [--persistent] [--lod] [--lod-density D] [--prefetch] [--prefetch-frames N] [--cull-threads N] [--occlusion] [--occlusion-samples N] [--backend points|compute] [--progressive] [--progressive-blocks N] [--partition grid|kd] [--grid N] [--max-block-points N] [--compress none|zstd] [--slot-factor F] [--subslot-ratio R] [--workers N] [--io mmap|pread|uring] [--direct-io] [--io-depth N] [--rotate DEG] [--resolution WxH] [--upload-mb MB] [--upload-ms MS] [--target-ms MS] [--vram-fraction F] [--warmup N] [--frames N] [--camera-path file|orbit] [--record-path file] [--trace out.json] [--bench prefix] [--bench-config file] [--bench-run i] [--export] [--export-format png|raw] [--export-writers N]
  */
 int main(int argc, char **argv) {
 
-  // default settings
-  std::string shader_vert = "../src/shader/shader.vert";
-  std::string shader_frag = "../src/shader/shader.frag";
-  std::string plyPath = "../data/Church.ply";
-  std::string outDir = "../data";
-  bool isTest = false;
-  bool isOOC = false;
-  bool isExport = false;
-  bool isCache = false;
+  // default settings, see RasterizerConfig
+  RasterizerConfig config;
+  BenchmarkMatrix matrix;
+  std::string benchPrefix;     // empty = single interactive/test run
+  int benchRun = -1;           // only this combination of the matrix, -1 = all
 
   for (int i = 1; i < argc; i++){
     std::string arg = argv[i];
     if (arg == "--test"){
-      isTest = true;
+      config.isTest = true;
+      continue;
+    }
+    if (arg == "--headless"){
+      // no visible window: offscreen framebuffer, no swap, no input
+      config.isHeadless = true;
       continue;
     }
     if (arg == "--export"){
-      isExport = true;
+      config.isExport = true;
+      continue;
+    }
+    if (arg == "--export-format" && i + 1 < argc) {
+      // png, or raw RGBA8 frames to encode after the run
+      std::string name = argv[++i];
+      if (!parseExportFormat(name, config.exportFormat)) {
+        std::cerr << "Unknown export format: " << name << " (png|raw)" << std::endl;
+        return 1;
+      }
+      continue;
+    }
+    if (arg == "--export-writers" && i + 1 < argc) {
+      config.exportWriters = std::stoi(argv[++i]);
       continue;
     }
     if (arg == "--ooc") {
       // out-of-core mode: points will be seperated into blocks in the directory "data"
-      isOOC = true;
+      config.isOOC = true;
       continue;
     }
     if (arg == "--cache") {
       // out-of-core mode: points will be seperated into blocks in the directory "data"
-      isCache = true;
+      config.isCache = true;
+      continue;
+    }
+    if (arg == "--async") {
+      // out-of-core mode: consume only finished jobs per frame, the rest carries over
+      config.isAsync = true;
+      continue;
+    }
+    if (arg == "--rebuild") {
+      // ignore the block store of a previous run and partition again
+      config.isRebuild = true;
+      continue;
+    }
+    if (arg == "--persistent") {
+      // out-of-core mode: workers write into a persistently mapped staging ring
+      config.isPersistent = true;
+      continue;
+    }
+    if (arg == "--lod") {
+      // load and draw a point budget per block from its size on screen
+      config.isLOD = true;
+      continue;
+    }
+    if (arg == "--prefetch") {
+      // out-of-core mode with cache: load blocks the camera is heading for into subslots
+      config.isPrefetch = true;
+      continue;
+    }
+    if (arg == "--prefetch-frames" && i + 1 < argc) {
+      config.prefetchFrames = std::stoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--occlusion") {
+      // hide blocks in the frustum whose boxes are behind drawn points
+      config.isOcclusion = true;
+      continue;
+    }
+    if (arg == "--occlusion-samples" && i + 1 < argc) {
+      config.occlusionSamples = std::stoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--progressive") {
+      // refine a still view beyond the slot/LOD budgets in an accumulated framebuffer
+      config.isProgressive = true;
+      continue;
+    }
+    if (arg == "--progressive-blocks" && i + 1 < argc) {
+      config.progressiveBlocks = std::stoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--cull-threads" && i + 1 < argc) {
+      // split frustum culling over threads once there are many blocks
+      config.cullThreads = std::stoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--lod-density" && i + 1 < argc) {
+      config.lodDensity = std::stof(argv[++i]);
+      continue;
+    }
+    if (arg == "--compress" && i + 1 < argc) {
+      // layout of the block store, a different one rebuilds it
+      std::string name = argv[++i];
+      if (!parseCompression(name, config.partition.compression)) {
+        std::cerr << "Unknown compression: " << name << " (none|zstd)" << std::endl;
+        return 1;
+      }
+      if (!compressionAvailable(config.partition.compression)) {
+        std::cerr << "Compression " << name << " is not available, configure with -DWITH_ZSTD=ON." << std::endl;
+        return 1;
+      }
+      continue;
+    }
+    if (arg == "--io" && i + 1 < argc) {
+      // how workers read blocks: mapping, pread() or io_uring batches
+      std::string name = argv[++i];
+      if (!parseIOBackend(name, config.io.backend)) {
+        std::cerr << "Unknown I/O backend: " << name << " (mmap|pread|uring)" << std::endl;
+        return 1;
+      }
+      if (!ioBackendAvailable(config.io.backend)) {
+        std::cerr << "I/O backend " << name << " is not available, configure with -DWITH_LIBURING=ON." << std::endl;
+        return 1;
+      }
+      continue;
+    }
+    if (arg == "--direct-io") {
+      config.io.direct = true;
+      continue;
+    }
+    if (arg == "--io-depth" && i + 1 < argc) {
+      config.io.depth = std::stoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--partition" && i + 1 < argc) {
+      // block layout: uniform grid or k-d splits to equal-sized blocks
+      std::string mode = argv[++i];
+      if (mode == "grid") {
+        config.partition.mode = PARTITION_GRID;
+      } else if (mode == "kd") {
+        config.partition.mode = PARTITION_KD;
+      } else {
+        std::cerr << "Unknown partition mode: " << mode << " (grid|kd)" << std::endl;
+        return 1;
+      }
+      continue;
+    }
+    if (arg.rfind("--", 0) == 0 && BenchmarkMatrix::isKey(arg.substr(2)) && i + 1 < argc) {
+      // --grid, --max-block-points, --slot-factor, --subslot-ratio, --workers, --rotate, --resolution,
+      // --camera-path, --cache-policy, --backend:
+      // one value, or a comma separated list to sweep with --bench
+      if (!matrix.set(arg.substr(2), argv[++i])) return 1;
+      continue;
+    }
+    if (arg == "--upload-mb" && i + 1 < argc) {
+      config.uploadBudgetMB = std::stof(argv[++i]);
+      continue;
+    }
+    if (arg == "--upload-ms" && i + 1 < argc) {
+      config.uploadBudgetMs = std::stof(argv[++i]);
+      continue;
+    }
+    if (arg == "--target-ms" && i + 1 < argc) {
+      // adapt slots and points per block to hold this frame time
+      config.targetFrameMs = std::stof(argv[++i]);
+      continue;
+    }
+    if (arg == "--vram-fraction" && i + 1 < argc) {
+      config.vramFraction = std::stof(argv[++i]);
+      continue;
+    }
+    if (arg == "--warmup" && i + 1 < argc) {
+      config.warmup = std::stoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--frames" && i + 1 < argc) {
+      config.frames = std::stoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--record-path" && i + 1 < argc) {
+      // save the camera pose of every frame, for replay with --camera-path
+      config.cameraRecordPath = argv[++i];
+      continue;
+    }
+    if (arg == "--trace" && i + 1 < argc) {
+      // write a Chrome trace of main thread and worker sections
+      config.tracePath = argv[++i];
+      continue;
+    }
+    if (arg == "--bench" && i + 1 < argc) {
+      // run every combination of the matrix, results go to <prefix>_runs.csv, _frames.csv, .jsonl
+      benchPrefix = argv[++i];
+      continue;
+    }
+    if (arg == "--bench-config" && i + 1 < argc) {
+      if (!matrix.load(argv[++i])) return 1;
+      continue;
+    }
+    if (arg == "--bench-run" && i + 1 < argc) {
+      benchRun = std::stoi(argv[++i]);
       continue;
     }
     if (ends_with(arg, ".ply")){
-      plyPath = argv[i];
+      config.plyPath = argv[i];
       continue;
     }
     if (ends_with(arg, ".vert")){
-      shader_vert = argv[i];
+      config.shader_vert = argv[i];
       continue;
     }
     if (ends_with(arg, ".frag")){
-      shader_frag = argv[i];
+      config.shader_frag = argv[i];
       continue;
     }
   }
 
+  if (!benchPrefix.empty()) {
+    // benchmarks always follow the scripted camera
+    config.isTest = true;
+    Benchmark benchmark;
+    return benchmark.run(config, matrix, benchPrefix, benchRun) ? 0 : 1;
+  }
+  if (matrix.size() > 1) {
+    std::cerr << "Value lists sweep " << matrix.size() << " configurations, run them with --bench <prefix>." << std::endl;
+    return 1;
+  }
+
   Rasterizer rasterizer;
-  if (!rasterizer.init(plyPath, outDir, shader_vert, shader_frag, isTest, isOOC, isCache, isExport, 800, 600, 1.0, 100.0, 30.0,  0.05f, 0.30)) {
+  if (!rasterizer.init(matrix.at(config, 0))) {
     std::cout << "Failed to initialize Rasterizer." << std::endl;
     return 1;
   }
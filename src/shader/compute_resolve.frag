@@ -0,0 +1,15 @@
+#version 430 core
+// copies the compute framebuffer into color and depth of the default framebuffer
+layout (std430, binding = 2) readonly buffer Frame { uint pixels[]; }; // color, depth bits
+uniform ivec2 Size;
+out vec4 FragColor;
+
+void main()
+{
+  ivec2 px = ivec2(gl_FragCoord.xy);
+  uint pix = uint(px.y * Size.x + px.x);
+  uint depth = pixels[2u * pix + 1u];
+  if (depth == 0xffffffffu) discard; // no point, keep the clear color
+  FragColor = vec4(unpackUnorm4x8(pixels[2u * pix]).rgb, 1.0);
+  gl_FragDepth = uintBitsToFloat(depth);
+}
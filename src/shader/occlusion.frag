@@ -0,0 +1,8 @@
+#version 330 core
+// color writes are masked, only the samples passing the depth test count
+out vec4 FragColor;
+
+void main()
+{
+	FragColor = vec4(1.0);
+}
@@ -0,0 +1,14 @@
+#version 330 core
+// bounding box of one block as a 14 vertex triangle strip, no vertex buffer
+
+uniform mat4 View;
+uniform mat4 Proj;
+uniform vec3 BoxMin;
+uniform vec3 BoxExtent;
+
+void main()
+{
+  int b = 1 << gl_VertexID;
+  vec3 corner = vec3((0x287a & b) != 0, (0x02af & b) != 0, (0x31e3 & b) != 0);
+  gl_Position = Proj * View * vec4(BoxMin + corner * BoxExtent, 1.0);
+}
@@ -1,15 +1,32 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aColor;
+layout (location = 0) in vec3 aPos;   // quantized, normalized to [0,1] within the block bbox
+layout (location = 1) in vec4 aColor; // RGBA8, normalized
 out vec3 VertexColor; // Output variable to send to Fragment Shader
 
 // matrices for transformations
 uniform mat4 Model;
 uniform mat4 View;
 uniform mat4 Proj;
+
+// quantization frame of the block being drawn
+uniform vec3 BlockMin;
+uniform vec3 BlockExtent;
+
+// out-of-core: the slot arena keeps one frame per region (bb_min, extent),
+// the region follows from the vertex index. 0 = use the uniforms above.
+uniform int PointsPerRegion;
+uniform samplerBuffer RegionFrames;
 void main()
 {
-  gl_Position = Proj * View * Model * vec4(aPos, 1.0);
+  vec3 frameMin = BlockMin;
+  vec3 frameExtent = BlockExtent;
+  if (PointsPerRegion > 0) {
+    int region = gl_VertexID / PointsPerRegion;
+    frameMin = texelFetch(RegionFrames, 2 * region).xyz;
+    frameExtent = texelFetch(RegionFrames, 2 * region + 1).xyz;
+  }
+  vec3 pos = frameMin + aPos * frameExtent;
+  gl_Position = Proj * View * Model * vec4(pos, 1.0);
   // Pass the color data from the attribute to the fragment shader
-  VertexColor = aColor;
+  VertexColor = aColor.rgb;
 }